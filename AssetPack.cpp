@@ -0,0 +1,299 @@
+//
+// AssetPack.cpp
+//
+
+// System includes.
+#if defined(_WIN32) || defined(_WIN64)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <string.h>
+
+// Engine includes.
+#include "LogManager.h"
+
+// Game includes.
+#include "AssetPack.h"
+
+AssetPack::AssetPack() {
+  m_p_data = NULL;
+  m_size = 0;
+  m_p_mapping = NULL;
+  m_p_entry = NULL;
+  m_count = 0;
+  m_next_job = 0;
+  m_jobs_left = 0;
+  m_ready = false;
+}
+
+// Get the one and only instance of the AssetPack.
+AssetPack &AssetPack::getInstance() {
+  static AssetPack asset_pack;
+  return asset_pack;
+}
+
+// Destructor, closes pack.
+AssetPack::~AssetPack() {
+  close();
+}
+
+// Map pack file and check header and entries.
+// Return 0 if ok, else -1.
+int AssetPack::open(std::string filename) {
+
+  if (m_p_data)
+    return 0;
+
+  // Map whole file read only.  Pages are read in as touched.
+#if defined(_WIN32) || defined(_WIN64)
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+			    NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    return -1;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    return -1;
+  }
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (!mapping)
+    return -1;
+  void *p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!p) {
+    CloseHandle(mapping);
+    return -1;
+  }
+  m_p_mapping = mapping;
+  m_size = (size_t) size.QuadPart;
+#else
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return -1;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return -1;
+  }
+  void *p = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED)
+    return -1;
+  m_size = (size_t) st.st_size;
+#endif
+  m_p_data = (const char *) p;
+
+  // Check header and that every entry lies inside file.
+  const PackHeader *p_h = (const PackHeader *) m_p_data;
+  if (m_size < sizeof(PackHeader) ||
+      memcmp(p_h -> magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 ||
+      p_h -> version != PACK_VERSION ||
+      sizeof(PackHeader) + (uint64_t) p_h -> count * sizeof(PackEntry) > m_size) {
+    LM.writeLog("AssetPack::open(): Error! %s is not a version %u pack.",
+		filename.c_str(), PACK_VERSION);
+    close();
+    return -1;
+  }
+  m_p_entry = (const PackEntry *) (m_p_data + sizeof(PackHeader));
+  m_count = (int) p_h -> count;
+  for (int i=0; i<m_count; i++) {
+    const PackEntry &e = m_p_entry[i];
+    if (e.label[PACK_LABEL_LEN-1] != '\0' || e.channels == 0 ||
+	e.offset % 8 != 0 || e.offset > m_size ||
+	e.sample_count > (m_size - e.offset) / sizeof(int16_t)) {
+      LM.writeLog("AssetPack::open(): Error! %s entry %d is bad.",
+		  filename.c_str(), i);
+      close();
+      return -1;
+    }
+  }
+
+  LM.writeLog("AssetPack::open(): %s mapped, %d sounds, %u KB.",
+	      filename.c_str(), m_count, (unsigned int) (m_size / 1024));
+  return 0;
+}
+
+// Load sounds (label, file); handle is index in list.  From pack
+// if open (by label), else decode files in worker threads.
+// Sounds are playable after wait().
+void AssetPack::load(const std::vector<std::pair<std::string, std::string>> &sounds) {
+
+  if (!m_sounds.empty())
+    return;
+
+  // All list changes here, on caller's thread; workers only fill buffers.
+  for (size_t i=0; i<sounds.size(); i++) {
+    PackSound *p_s = new PackSound;
+    p_s -> file = sounds[i].second;
+    p_s -> entry = -1;
+    p_s -> state = PACK_EMPTY;
+    m_sounds.push_back(p_s);
+  }
+
+  m_next_job = 0;
+  m_jobs_left = (int) m_sounds.size();
+  m_start = std::chrono::steady_clock::now();
+  m_done = m_start;
+
+  // Pack: find each label once.  Playable now; one thread prefetches
+  // (pages in and fills) buffers in list order, in the background.
+  if (m_p_data) {
+    int found = 0;
+    for (size_t i=0; i<m_sounds.size(); i++) {
+      PackSound *p_s = m_sounds[i];
+      for (int j=0; j<m_count; j++)
+	if (sounds[i].first == m_p_entry[j].label) {
+	  p_s -> entry = j;
+	  found += 1;
+	  break;
+	}
+      if (p_s -> entry < 0) {
+	p_s -> state = PACK_FAILED;
+	LM.writeLog("AssetPack::load(): Error! %s not in pack.",
+		    sounds[i].first.c_str());
+      }
+    }
+    m_count = found;
+    m_ready = true;
+    m_workers.push_back(std::thread(&AssetPack::work, this));
+    return;
+  }
+
+  // Files: decode in background.
+  m_ready = false;
+
+  int workers = (int) std::thread::hardware_concurrency();
+  if (workers > PACK_MAX_WORKERS)
+    workers = PACK_MAX_WORKERS;
+  if (workers > (int) m_sounds.size())
+    workers = (int) m_sounds.size();
+  if (workers < 1)
+    workers = 1;
+  for (int i=0; i<workers; i++)
+    m_workers.push_back(std::thread(&AssetPack::work, this));
+  LM.writeLog("AssetPack::load(): decoding %d sounds on %d threads.",
+	      (int) m_sounds.size(), workers);
+}
+
+// Worker thread body: decode (files) or fill (pack) jobs until
+// none left.
+void AssetPack::work() {
+  int i;
+  while ((i = m_next_job++) < (int) m_sounds.size()) {
+    PackSound *p_s = m_sounds[i];
+    if (m_p_data)
+      fill(p_s);
+    else
+      p_s -> state = p_s -> buffer.loadFromFile(p_s -> file) ?
+	PACK_READY : PACK_FAILED;
+    if (--m_jobs_left == 0)
+      m_done = std::chrono::steady_clock::now();
+  }
+}
+
+// Fill buffer from pack, unless another thread has claimed it.
+// SFML copies samples, paging them in.
+// Return true if buffer is ready.
+bool AssetPack::fill(PackSound *p_s) {
+  int expected = PACK_EMPTY;
+  if (!p_s -> state.compare_exchange_strong(expected, PACK_FILLING))
+    return expected == PACK_READY;
+  const PackEntry &e = m_p_entry[p_s -> entry];
+  const sf::Int16 *p_samples = (const sf::Int16 *) (m_p_data + e.offset);
+  bool ok = p_s -> buffer.loadFromSamples(p_samples, e.sample_count,
+					  e.channels, e.sample_rate);
+  p_s -> state = ok ? PACK_READY : PACK_FAILED;
+  return ok;
+}
+
+// Barrier: block until all sounds decoded, then make them playable.
+// Logs decode time and how long caller waited.
+void AssetPack::wait() {
+
+  if (m_ready)
+    return;
+
+  std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+  for (size_t i=0; i<m_workers.size(); i++)
+    m_workers[i].join();
+  m_workers.clear();
+  std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
+
+  int ok = 0;
+  for (size_t i=0; i<m_sounds.size(); i++) {
+    if (m_sounds[i] -> state == PACK_READY)
+      ok += 1;
+    else
+      LM.writeLog("AssetPack::wait(): Error! Unable to load %s.",
+		  m_sounds[i] -> file.c_str());
+  }
+  m_count = ok;
+  m_ready = true;
+
+  LM.writeLog("AssetPack::wait(): %d sounds decoded in %.1f ms, waited %.1f ms.",
+	      ok, std::chrono::duration<float, std::milli>(m_done - m_start).count(),
+	      std::chrono::duration<float, std::milli>(after - before).count());
+}
+
+// Release sounds and unmap file.
+void AssetPack::close() {
+
+  // Let workers finish before freeing their sounds.
+  for (size_t i=0; i<m_workers.size(); i++)
+    m_workers[i].join();
+  m_workers.clear();
+  m_ready = false;
+
+  for (size_t i=0; i<m_sounds.size(); i++)
+    delete m_sounds[i];
+  m_sounds.clear();
+
+  if (!m_p_data)
+    return;
+#if defined(_WIN32) || defined(_WIN64)
+  UnmapViewOfFile(m_p_data);
+  CloseHandle((HANDLE) m_p_mapping);
+  m_p_mapping = NULL;
+#else
+  munmap((void *) m_p_data, m_size);
+#endif
+  m_p_data = NULL;
+  m_size = 0;
+  m_p_entry = NULL;
+  m_count = 0;
+}
+
+// Return true if pack open.
+bool AssetPack::isOpen() const {
+  return m_p_data != NULL;
+}
+
+// Get number of sounds loaded.
+int AssetPack::getCount() const {
+  return m_count;
+}
+
+// Get sound buffer for handle, filled from pack now if prefetch
+// has not reached it.
+// Return NULL if bad handle, not loaded, not yet ready or being
+// filled by prefetch.
+const sf::SoundBuffer *AssetPack::getBuffer(int handle) {
+
+  if (!m_ready || handle < 0 || handle >= (int) m_sounds.size())
+    return NULL;
+
+  PackSound *p_s = m_sounds[handle];
+  if (p_s -> state == PACK_READY)
+    return &p_s -> buffer;
+
+  // Played before prefetch got to it: fill now (as first play did
+  // before prefetch).  Skipped, not waited for, if being filled.
+  if (m_p_data && p_s -> state == PACK_EMPTY && fill(p_s))
+    return &p_s -> buffer;
+  return NULL;
+}
@@ -0,0 +1,148 @@
+//
+// AssetPack.h
+//
+// Game-owned sound effects, from one of two sources:
+//  - Pack file of sounds pre-decoded to 16-bit PCM (built offline by
+//    fruit-pack), memory mapped at start up.  Nothing is decoded and
+//    nothing is read at load: a prefetch thread then pages each sound
+//    in and hands its samples to SFML, in the background.  A sound
+//    played before the prefetch reaches it is filled on first play,
+//    as before; one played while being filled is skipped that once.
+//  - WAV files, decoded in parallel by a pool of worker threads while
+//    the game carries on (e.g., player types server name).  Sounds are
+//    not played until all are decoded; wait() is the barrier.
+// Sounds are looked up by handle (index in list given to load()), so
+// labels are only compared once, at load.
+//
+// File layout (native byte order):
+//   PackHeader, PackEntry[count], then samples, each 8-byte aligned.
+//
+// Sprites stay text, loaded by ResourceManager, since Animation
+// sync resolves sprites by name there.
+//
+
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+// System includes.
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// SFML includes.
+#include <SFML/Audio.hpp>
+
+// AssetPack settings.
+const char PACK_FILE[] = "fruit.pack";
+const char PACK_MAGIC[4] = {'F', 'P', 'A', 'K'};
+const uint32_t PACK_VERSION = 1;
+const int PACK_LABEL_LEN = 32;        // including NUL
+const int PACK_MAX_WORKERS = 4;       // WAV decode threads
+
+// Start of file.
+struct PackHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t count;                     // number of entries
+  uint32_t reserved;
+};
+
+// One sound.
+struct PackEntry {
+  char label[PACK_LABEL_LEN];         // name looked up at load
+  uint32_t channels;
+  uint32_t sample_rate;
+  uint64_t sample_count;              // 16-bit samples, all channels
+  uint64_t offset;                    // from start of file
+};
+
+// Sound buffer states.
+enum PackState {
+  PACK_EMPTY,                         // not yet filled
+  PACK_FILLING,                       // being filled (one thread)
+  PACK_READY,                         // filled, playable
+  PACK_FAILED,                        // not in pack, or unable to load
+};
+
+// Sound filled from pack (by prefetch or first play), or decoded from
+// file by worker.
+struct PackSound {
+  std::string file;                   // WAV file, if not from pack
+  int entry;                          // pack entry, if from pack
+  std::atomic<int> state;             // PackState
+  sf::SoundBuffer buffer;
+};
+
+// Two-letter acronym for easier access to asset pack.
+#define PACK AssetPack::getInstance()
+
+class AssetPack {
+
+ private:
+  AssetPack();                          // Private since a singleton.
+  AssetPack(AssetPack const&);          // Don't allow copy.
+  void operator=(AssetPack const&);     // Don't allow assignment.
+
+  const char *m_p_data;                 // mapped file, NULL if not open
+  size_t m_size;                        // mapped length
+  void *m_p_mapping;                    // file mapping handle (Windows)
+  const PackEntry *m_p_entry;           // entry table, in mapped file
+  int m_count;                          // number of entries
+  std::vector<PackSound *> m_sounds;    // by handle
+
+  std::atomic<int> m_next_job;          // next job to take
+  std::atomic<int> m_jobs_left;         // jobs not yet finished
+  std::vector<std::thread> m_workers;   // decode threads
+  bool m_ready;                         // true once sounds playable
+  std::chrono::steady_clock::time_point m_start; // when decode started
+  std::chrono::steady_clock::time_point m_done;  // when last job finished
+
+  // Worker thread body: decode (files) or fill (pack) jobs until
+  // none left.
+  void work();
+
+  // Fill buffer from pack, unless another thread has claimed it.
+  // Return true if buffer is ready.
+  bool fill(PackSound *p_s);
+
+ public:
+
+  // Get the one and only instance of the AssetPack.
+  static AssetPack &getInstance();
+
+  // Destructor, closes pack.
+  ~AssetPack();
+
+  // Map pack file and check header and entries.
+  // Return 0 if ok, else -1.
+  int open(std::string filename = PACK_FILE);
+
+  // Load sounds (label, file); handle is index in list.  From pack
+  // if open (by label), else decode files in worker threads.
+  // Sounds are playable after wait().
+  void load(const std::vector<std::pair<std::string, std::string>> &sounds);
+
+  // Barrier: block until all sounds decoded, then make them playable.
+  // Logs decode time and how long caller waited.
+  void wait();
+
+  // Release sounds and unmap file.
+  void close();
+
+  // Return true if pack open.
+  bool isOpen() const;
+
+  // Get number of sounds loaded.
+  int getCount() const;
+
+  // Get sound buffer for handle, filled from pack now if prefetch
+  // has not reached it.
+  // Return NULL if bad handle, not loaded, not yet ready or being
+  // filled by prefetch.
+  const sf::SoundBuffer *getBuffer(int handle);
+};
+
+#endif // ASSET_PACK_H
@@ -0,0 +1,174 @@
+//
+// BinLog.cpp
+//
+
+// System includes.
+#include <chrono>
+
+// Engine includes.
+#include "LogManager.h"
+
+// Game includes.
+#include "BinLog.h"
+
+BinLog::BinLog() {
+  m_enabled = false;
+  m_running = false;
+  m_formats_written = 0;
+  m_p_file = NULL;
+  m_start = std::chrono::duration_cast<std::chrono::nanoseconds>
+    (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Get the one and only instance of the BinLog.
+BinLog &BinLog::getInstance() {
+  static BinLog binlog;
+  return binlog;
+}
+
+// Open file and start drain thread.
+// Return 0 if ok, else -1.
+int BinLog::startUp(std::string filename) {
+
+  if (m_running)
+    return 0;
+
+  m_p_file = fopen(filename.c_str(), "wb");
+  if (!m_p_file) {
+    LM.writeLog("BinLog::startUp(): Error! Unable to open '%s'.",
+		filename.c_str());
+    return -1;
+  }
+  fwrite(BINLOG_MAGIC, sizeof(BINLOG_MAGIC), 1, m_p_file);
+  fwrite(&BINLOG_VERSION, sizeof(BINLOG_VERSION), 1, m_p_file);
+
+  m_running = true;
+  m_drain = std::thread(&BinLog::drainLoop, this);
+  m_enabled = true;
+
+  LM.writeLog("BinLog::startUp(): Binary log to '%s'.", filename.c_str());
+  return 0;
+}
+
+// Stop drain thread, writing any remaining records, and close file.
+void BinLog::shutDown() {
+
+  if (!m_running)
+    return;
+
+  m_enabled = false;
+  m_running = false;
+  m_drain.join();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (int i=0; i<(int) m_ring.size(); i++)
+    if (m_ring[i] -> dropped > 0)
+      LM.writeLog("BinLog::shutDown(): thread %d dropped %u records.",
+		  i, m_ring[i] -> dropped);
+
+  fclose(m_p_file);
+  m_p_file = NULL;
+}
+
+// Keep (true) or discard (false) records from log calls.
+// Only takes effect after startUp().
+void BinLog::setEnabled(bool enabled) {
+  m_enabled = enabled && m_running;
+}
+
+// Register format string, returning its id.
+int BinLog::addFormat(const char *fmt) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_format.push_back(fmt);
+  return (int) m_format.size() - 1;
+}
+
+// Get number of records waiting to be drained, over all threads.
+int BinLog::getPending() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  int pending = 0;
+  for (int i=0; i<(int) m_ring.size(); i++)
+    pending += (int) (m_ring[i] -> head.load(std::memory_order_acquire) -
+		      m_ring[i] -> tail.load(std::memory_order_acquire));
+  return pending;
+}
+
+// Get ring for calling thread (created on first use).
+// Rings live until exit, since drain thread may still be reading.
+BinRing *BinLog::threadRing() {
+  static thread_local BinRing *tl_p_ring = NULL;
+  if (!tl_p_ring) {
+    BinRing *p_ring = new BinRing;
+    p_ring -> head = 0;
+    p_ring -> tail = 0;
+    p_ring -> dropped = 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    p_ring -> thread = (int) m_ring.size();
+    m_ring.push_back(p_ring);
+    tl_p_ring = p_ring;
+  }
+  return tl_p_ring;
+}
+
+// Get time since start up, in ns.
+uint64_t BinLog::now() const {
+  int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>
+    (std::chrono::steady_clock::now().time_since_epoch()).count();
+  return (uint64_t) (ns - m_start);
+}
+
+// Drain thread body.
+void BinLog::drainLoop() {
+  while (m_running) {
+    drainAll();
+    std::this_thread::sleep_for(std::chrono::milliseconds(BINLOG_DRAIN_MS));
+  }
+  drainAll();
+  fflush(m_p_file);
+}
+
+// Write all pending records to file.
+// Formats are written before the first record using them, so heads
+// are read before formats (a format is added before its records).
+void BinLog::drainAll() {
+
+  std::vector<BinRing *> rings;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    rings = m_ring;
+  }
+  std::vector<uint32_t> heads;
+  for (int i=0; i<(int) rings.size(); i++)
+    heads.push_back(rings[i] -> head.load(std::memory_order_acquire));
+
+  std::vector<std::string> formats;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (int i=m_formats_written; i<(int) m_format.size(); i++)
+      formats.push_back(m_format[i]);
+  }
+
+  for (int i=0; i<(int) formats.size(); i++) {
+    uint16_t id = (uint16_t) (m_formats_written + i);
+    uint16_t len = (uint16_t) formats[i].size();
+    fputc(BINLOG_FORMAT, m_p_file);
+    fwrite(&id, sizeof(id), 1, m_p_file);
+    fwrite(&len, sizeof(len), 1, m_p_file);
+    fwrite(formats[i].c_str(), len, 1, m_p_file);
+  }
+  m_formats_written += (int) formats.size();
+
+  for (int i=0; i<(int) rings.size(); i++) {
+    BinRing *p_ring = rings[i];
+    uint8_t thread = (uint8_t) p_ring -> thread;
+    uint32_t tail = p_ring -> tail.load(std::memory_order_relaxed);
+    while (tail != heads[i]) {
+      fputc(BINLOG_RECORD, m_p_file);
+      fwrite(&thread, sizeof(thread), 1, m_p_file);
+      fwrite(&p_ring -> record[tail & (BINLOG_RING - 1)],
+	     sizeof(BinRecord), 1, m_p_file);
+      tail += 1;
+    }
+    p_ring -> tail.store(tail, std::memory_order_release);
+  }
+}
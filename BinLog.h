@@ -0,0 +1,169 @@
+//
+// BinLog.h
+//
+// Binary logging for hot paths (per-tick syncs, mouse moves, pings).
+// A call stores a format id and raw arguments in a per-thread,
+// lock-free ring (single producer, single consumer).  No formatting
+// or file I/O is done on the calling thread: a background thread
+// drains rings to a binary file, turned back into text offline by
+// fruit-logdump.  Arguments are numbers only (int, unsigned, bool,
+// int64_t, float, double), so format strings use %d, %u, %x, %f or %g.
+//
+// Usage: BINLOG("Server::sync(): SYNC type %d (id %d)", type, id);
+//
+
+#ifndef BINLOG_H
+#define BINLOG_H
+
+// System includes.
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// BinLog settings.
+const int BINLOG_MAX_ARGS = 6;        // max arguments per call
+const int BINLOG_RING = 4096;         // records per thread, power of 2
+const int BINLOG_DRAIN_MS = 5;        // drain period, in milliseconds
+const char BINLOG_MAGIC[4] = {'B', 'L', 'O', 'G'};
+const uint32_t BINLOG_VERSION = 1;
+
+// File entry kinds.
+const char BINLOG_FORMAT = 'F';       // uint16 id, uint16 len, chars
+const char BINLOG_RECORD = 'R';       // uint8 thread, BinRecord
+
+// Argument types.
+const uint8_t BINLOG_INT = 'i';
+const uint8_t BINLOG_DOUBLE = 'f';
+
+// One log call: 24-byte header, then argument slots (72 bytes).
+struct BinRecord {
+  uint64_t time;                      // ns since BinLog start up
+  uint16_t fmt;                       // format id
+  uint8_t count;                      // number of arguments
+  uint8_t type[BINLOG_MAX_ARGS];      // type of each argument
+  uint8_t pad;
+  union {
+    int64_t i;
+    double f;
+  } arg[BINLOG_MAX_ARGS];             // argument values
+};
+
+// Per-thread ring of records.
+struct BinRing {
+  std::atomic<uint32_t> head;         // next to write (producer)
+  std::atomic<uint32_t> tail;         // next to read (consumer)
+  uint32_t dropped;                   // records dropped, ring full
+  int thread;                         // thread number, in order seen
+  BinRecord record[BINLOG_RING];
+};
+
+// Store argument in record.
+inline void binlogArg(BinRecord &r, int64_t v) {
+  r.type[r.count] = BINLOG_INT;
+  r.arg[r.count++].i = v;
+}
+inline void binlogArg(BinRecord &r, int v) { binlogArg(r, (int64_t) v); }
+inline void binlogArg(BinRecord &r, unsigned int v) { binlogArg(r, (int64_t) v); }
+inline void binlogArg(BinRecord &r, bool v) { binlogArg(r, (int64_t) v); }
+inline void binlogArg(BinRecord &r, double v) {
+  r.type[r.count] = BINLOG_DOUBLE;
+  r.arg[r.count++].f = v;
+}
+inline void binlogArg(BinRecord &r, float v) { binlogArg(r, (double) v); }
+
+// Two-letter acronym for easier access to binary log.
+#define BL BinLog::getInstance()
+
+// Log call site: format registered once, then record written.
+#define BINLOG(fmt, ...)						\
+  do {									\
+    if (BL.isEnabled()) {						\
+      static const int s_binlog_fmt = BL.addFormat(fmt);		\
+      BL.write(s_binlog_fmt, ##__VA_ARGS__);				\
+    }									\
+  } while (0)
+
+class BinLog {
+
+ private:
+  BinLog();                           // Private since a singleton.
+  BinLog(BinLog const&);              // Don't allow copy.
+  void operator=(BinLog const&);      // Don't allow assignment.
+
+  std::atomic<bool> m_enabled;        // true if records are kept
+  std::atomic<bool> m_running;        // true while drain thread runs
+  std::thread m_drain;                // background drain thread
+  std::mutex m_mutex;                 // guards formats and rings lists
+  std::vector<std::string> m_format;  // format string for each id
+  std::vector<BinRing *> m_ring;      // one ring per logging thread
+  int m_formats_written;              // formats already in file
+  FILE *m_p_file;                     // output file
+  int64_t m_start;                    // start up time, in ns
+
+  // Get ring for calling thread (created on first use).
+  BinRing *threadRing();
+
+  // Get time since start up, in ns.
+  uint64_t now() const;
+
+  // Drain thread body.
+  void drainLoop();
+
+  // Write all pending records to file.
+  void drainAll();
+
+ public:
+
+  // Get the one and only instance of the BinLog.
+  static BinLog &getInstance();
+
+  // Open file and start drain thread.
+  // Return 0 if ok, else -1.
+  int startUp(std::string filename);
+
+  // Stop drain thread, writing any remaining records, and close file.
+  void shutDown();
+
+  // Return true if log calls keep records.
+  bool isEnabled() const {
+    return m_enabled.load(std::memory_order_relaxed);
+  }
+
+  // Keep (true) or discard (false) records from log calls.
+  // Only takes effect after startUp().
+  void setEnabled(bool enabled);
+
+  // Register format string, returning its id.
+  int addFormat(const char *fmt);
+
+  // Get number of records waiting to be drained, over all threads.
+  int getPending();
+
+  // Write record with format id and up to BINLOG_MAX_ARGS arguments.
+  // If ring is full, record is dropped.
+  template <typename... Args>
+  void write(int fmt, Args... args) {
+    static_assert(sizeof...(Args) <= BINLOG_MAX_ARGS,
+		  "BinLog: too many arguments");
+    BinRing *p_ring = threadRing();
+    uint32_t head = p_ring -> head.load(std::memory_order_relaxed);
+    uint32_t tail = p_ring -> tail.load(std::memory_order_acquire);
+    if (head - tail == (uint32_t) BINLOG_RING) {
+      p_ring -> dropped += 1;
+      return;
+    }
+    BinRecord &r = p_ring -> record[head & (BINLOG_RING - 1)];
+    r.time = now();
+    r.fmt = (uint16_t) fmt;
+    r.count = 0;
+    int unpack[] = {0, (binlogArg(r, args), 0)...};
+    (void) unpack;
+    p_ring -> head.store(head + 1, std::memory_order_release);
+  }
+};
+
+#endif // BINLOG_H
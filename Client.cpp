@@ -3,6 +3,8 @@
 //
 
 // System includes.
+#include <stdio.h>  // for sscanf()
+#include <stdlib.h> // for strtol()
 #include <string.h> // for memcpy()
 
 // Engine includes.
@@ -18,19 +20,27 @@
 #include "EventNetworkCreate.h"
 
 // Game includes.
+#include "AssetPack.h"
+#include "BinLog.h"
 #include "Client.h"
+#include "Compositor.h"
+#include "FrameBudget.h"
 #include "Fruit.h"
 #include "GameOver.h"
+#include "InputSampler.h"
 #include "Kudos.h"
 #include "Points.h"
+#include "Profiler.h"
+#include "Registry.h"
 #include "ServerEntry.h"
 #include "Sword.h"
+#include "Telemetry.h"
 #include "Timer.h"
 #include "util.h"
 #include "PingEvent.h"
 #include "Ping.h"
 
-Client::Client() {
+Client::Client(int input_rate_hz) {
 
     // Set as network client.
     setType(CLIENT_STRING);
@@ -42,8 +52,14 @@ Client::Client() {
         exit(-1);
     }
 
-    // Client handles mouse, sending it to Server.
+    // Game characters are drawn in one batch per frame.
+    Compositor::getInstance();
+
+    // Client handles mouse, sending it to Server: sampled on own
+    // thread if there is a window, else from mouse events.
     registerInterest(df::MSE_EVENT);
+    if (IS.startUp(DM.getWindow(), input_rate_hz) == 0)
+        LM.writeLog("Client::Client(): Sampling mouse at %d Hz.", input_rate_hz);
 
     // Keyboard for Q to quit.
     registerInterest(df::KEYBOARD_EVENT);
@@ -58,8 +74,10 @@ Client::Client() {
 
     // Initialize Variables
     ping_count = 0; // step count 15 ticks
+    ping_seq = 0;
     latency = 0;
     client_id = 0;
+    input_ticks = 0;
 
 }
 
@@ -91,35 +109,104 @@ int Client::eventHandler(const df::Event* p_e) {
 // Handle step event.
 int Client::step(const df::EventStep* p_e) {
 
+    // Scale effects to hold frame time.
+    FB.step();
+
+    // Mouse path since last step (window may have moved).
+    IS.publish();
+    sendInput();
+
     ping_count++;
     // Every ping_delay steps, send a PING message.
     if (ping_count >= 15) {
-        int ping_time = GM.getStepCount();  // Get the current step count.
 
-        // Construct PING message: "Ping: <time>"
+        // Construct PING message: "Ping <seq> <time in microseconds>"
         char buff[50];
-        sprintf_s(buff, "Ping %d", ping_time);
+        sprintf_s(buff, "Ping %d %lld", ping_seq, (long long)Telemetry::now());
 
         // Send PING to the server
-        if (sendMessage(df::MessageType::CUSTOM_MESSAGE, (int)strlen(buff), buff)) {
-            LM.writeLog("Client::handleStep(): PING message sent.");
+        if (sendMessage(df::MessageType::CUSTOM_MESSAGE, (int)strlen(buff) + 1, buff)) {
+            TM.sent(0, ping_seq);
+            BINLOG("Client::step(): PING %d sent.", ping_seq);
         }
         else {
             LM.writeLog(1, "Client::handleStep(): Error sending PING message.");
         }
 
+        ping_seq++;
         ping_count = 0;
     }
     return 1;
 }
 
+// Send sampled mouse path: local sword follows all of it, as
+// will server's.  Return number of samples used.
+int Client::sendInput() {
+
+    PROFILE_SCOPE(PROFILE_INPUT);
+
+    if (!IS.isStarted())
+        return 0;
+
+    static InputSample samples[INPUT_RING];
+    static df::Vector path[INPUT_RING];
+    int n = IS.drain(samples, INPUT_RING);
+
+    // If not connected, samples are dropped.
+    if (n == 0 || NM.isConnected() == false)
+        return 0;
+
+    for (int i = 0; i < n; i++)
+        path[i] = df::viewToWorld(df::pixelsToSpaces(
+            df::Vector((float)samples[i].x, (float)samples[i].y)));
+
+    // Local sword, right away (as server will for its copy).
+    for (int i = 0; i < Registry<Sword>::getCount(); i++) {
+        Sword* p_s = Registry<Sword>::get(i);
+        if (p_s->getSocketIndex() == client_id)
+            p_s->moveAlong(path, n);
+    }
+
+    // Samples to server, repeating those of last K packets so
+    // lost packets cost nothing.  K follows ping loss.
+    const ConnectionTelemetry* p_ct = TM.get(0);
+    if (p_ct)
+        input_encoder.adapt(p_ct->getLoss());
+    int bytes = input_encoder.encode(path, n);
+    sendMessage(df::MessageType::CUSTOM_MESSAGE, bytes, input_encoder.getPacket());
+    BINLOG("Client::sendInput(): Send mouse (%f, %f), %d samples, %d bytes",
+        path[n - 1].getX(), path[n - 1].getY(), n, bytes);
+
+    // Input to send latency, each sample.
+    int64_t now = Telemetry::now();
+    for (int i = 0; i < n; i++)
+        input_latency.add((uint64_t)(now - samples[i].time) * 1000);
+    input_ticks++;
+    if (input_ticks >= PROFILE_DUMP_TICKS) {
+        LM.writeLog("Client::sendInput(): input to send p50 %.1f ms, p99 %.1f ms, max %.1f ms (%u samples, %u dropped)",
+            input_latency.getPercentile(50) / 1e6, input_latency.getPercentile(99) / 1e6,
+            input_latency.getMax() / 1e6, input_latency.getCount(), IS.getDropped());
+        input_latency.clear();
+        input_encoder.report();
+        input_ticks = 0;
+    }
+
+    return n;
+}
+
 // Handle mouse event.
 int Client::mouse(const df::EventMouse* p_e) {
 
+    PROFILE_SCOPE(PROFILE_INPUT);
+
     // If not connected, nothing to do.
     if (NM.isConnected() == false)
         return 0;
 
+    // Moves come from input sampler, if running.
+    if (IS.isStarted() && p_e->getMouseAction() == df::MOVED)
+        return 0;
+
     // Check if mouse outside game window.
     sf::RenderWindow* p_win = DM.getWindow();
     sf::Vector2i pos = sf::Mouse::getPosition(*p_win);
@@ -144,8 +231,8 @@ int Client::mouse(const df::EventMouse* p_e) {
         int ret = sendMessage(df::MessageType::MOUSE_INPUT, df::MOVED,
             df::Mouse::UNDEFINED_MOUSE_BUTTON,
             p_e->getMousePosition());
-        LM.writeLog(1, "Client::mouse(): Send mouse %s",
-            p_e->getMousePosition().toString().c_str());
+        BINLOG("Client::mouse(): Send mouse (%f, %f)",
+            p_e->getMousePosition().getX(), p_e->getMousePosition().getY());
         return 1; // Handled.
     }
     // If get here, not handled.
@@ -155,6 +242,8 @@ int Client::mouse(const df::EventMouse* p_e) {
 // Handle keyboard event.
 int Client::keyboard(const df::EventKeyboard* p_e) {
 
+    PROFILE_SCOPE(PROFILE_INPUT);
+
     // Only handle Q pressed.
     if (p_e->getKeyboardAction() == df::KEY_PRESSED &&
         p_e->getKey() == df::Keyboard::Q) {
@@ -172,35 +261,36 @@ df::Object* Client::createObject(std::string obj_type) {
     LM.writeLog(1, "Client::createObject(): Creating %s",
         obj_type.c_str());
 
+    // Sounds decoding in background must be done before game starts.
+    PACK.wait();
+
     df::Object* p_o = NULL;
 
-    if (obj_type == SWORD_STRING) {
+    switch (stringToGameType(obj_type)) {
+    case SWORD_TYPE:
         LM.writeLog(1, "Client::createObject(): Creating Sword");
         p_o = (df::Object*) new Sword();
-    }
-    else if (obj_type == "pear" ||
-        obj_type == "grapes" ||
-        obj_type == "apple" ||
-        obj_type == "banana" ||
-        obj_type == "blueberries") {
+        break;
+    case FRUIT_TYPE:
         LM.writeLog(1, "Client::createObject(): Creating %s", obj_type.c_str());
         p_o = (df::Object*) new Fruit(obj_type);
-    }
-    else if (obj_type == POINTS_STRING) {
+        break;
+    case POINTS_TYPE:
         LM.writeLog(1, "Client::createObject(): Creating Points");
         p_o = (df::Object*) new Points();
-    }
-    else if (obj_type == TIMER_STRING) {
+        break;
+    case TIMER_TYPE:
         LM.writeLog(1, "Client::createObject(): Creating Timer");
         p_o = (df::Object*) new Timer();
-    }
-    else if (obj_type == KUDOS_STRING) {
+        break;
+    case KUDOS_TYPE:
         LM.writeLog(1, "Client::createObject(): Creating Kudos");
         p_o = (df::Object*) new Kudos();
-    }
-    else {
+        break;
+    default:
         LM.writeLog(1, "Client::createObject(): Unknown type: %s",
             obj_type.c_str());
+        break;
     }
 
     return p_o;
@@ -209,33 +299,86 @@ df::Object* Client::createObject(std::string obj_type) {
 // Handle custom network event.
 int Client::net(const df::EventNetworkCustom* p_en) {
 
+    PROFILE_SCOPE(PROFILE_NETWORK);
+
     // Extract message from event
     const char* msg = static_cast<const char*>(p_en->getMessage());
 
+    // Handle other player's Sword path: follow curve through points.
+    // Its send time goes to latency estimate.
+    static df::Vector points[SPLINE_MAX_POINTS];
+    int id;
+    int64_t server_us;
+    int count = decodeSpline(p_en->getMessage(), p_en->getBytes(), &id,
+        &server_us, points, SPLINE_MAX_POINTS);
+    if (count >= 0) {
+        latency_estimator.addServerTime(server_us, Telemetry::now());
+        for (int i = 0; i < Registry<Sword>::getCount(); i++) {
+            Sword* p_s = Registry<Sword>::get(i);
+            if (p_s->getId() == id)
+                p_s->followSpline(points, count);
+        }
+        return 1;
+    }
+
     // Check message type
+    // Handle server PING: its send time goes to latency estimate,
+    // then echo it back unchanged.
+    if (strncmp(msg, "Sping", 5) == 0) {
+        int seq;
+        long long server_us;
+        if (sscanf(msg, "Sping %d %lld", &seq, &server_us) == 2)
+            latency_estimator.addServerTime((int64_t)server_us, Telemetry::now());
+        if (sendMessage(df::MessageType::CUSTOM_MESSAGE, (int)strlen(msg) + 1, msg) == -1)
+            LM.writeLog(1, "Client::net(): Error echoing server PING.");
+        return 1;
+    }
+
+    // Handle batched DELETE: "Delete <id> <id> ...".
+    if (strncmp(msg, "Delete", 6) == 0) {
+        const char* p = msg + 6;
+        char* p_end;
+        for (long id = strtol(p, &p_end, 10); p_end != p; id = strtol(p, &p_end, 10)) {
+            df::Object* p_o = WM.objectWithId((int)id);
+            if (p_o)
+                WM.markForDelete(p_o);
+            p = p_end;
+        }
+        return 1;
+    }
+
     // Handle PING message
     if (strncmp(msg, "Ping", 4) == 0) {
-        
-        char sent_t[50];
-        // Skip "Ping_"(5 bytes) and extract int time 
-        memcpy(&sent_t, msg + 5, sizeof(int));
 
-        // Calculate latency in game ticks
-        int latency_ticks = GM.getStepCount() - atoi(sent_t);
+        // Echo is "Ping <seq> <time sent> [<server time>]", in
+        // microseconds.
+        int seq;
+        long long sent_us;
+        long long server_us = -1;
+        if (sscanf(msg, "Ping %d %lld %lld", &seq, &sent_us, &server_us) < 2) {
+            LM.writeLog("Client::net(): ERROR Bad PING echo '%s'", msg);
+            return 1;
+        }
 
-        // Update latency
-        latency = latency_ticks;
+        // Round trip time, in ms (-1 if echo came after timeout).
+        float rtt = TM.received(0, seq, (int64_t)sent_us);
+        if (rtt < 0)
+            return 1;
 
-        // ticks to milliseconds
-        int latency_ms = latency_ticks * GM.getFrameTime();
+        // Update latency, in (fractional) game ticks, from estimate.
+        latency_estimator.addPing((int64_t)sent_us, (int64_t)server_us, Telemetry::now());
+        latency = latency_estimator.getRoundTrip() / GM.getFrameTime();
 
         // Trigger PING_EVENT or update Ping view object
-        PingEvent ping_event(latency_ms);
+        int latency_ms = (int)(latency_estimator.getRoundTrip() + 0.5f);
+        int spread_ms = (int)(2 * latency_estimator.getStdDev() + 0.5f);
+        PingEvent ping_event(latency_ms, spread_ms);
 
         // Send the PingEvent to the WorldManager
         WM.onEvent(&ping_event);
 
-        LM.writeLog("Client::net(): Receive PING echo. Latency: %d ms", latency_ms);
+        BINLOG("Client::net(): Receive PING echo. RTT %.1f ms, estimate %d +/- %d ms",
+            rtt, latency_ms, spread_ms);
         return 1; // Handled
     }
     // Handle GAME OVER message
@@ -267,18 +410,34 @@ int Client::handleClose(const df::EventNetwork* p_en) {
     return 1;
 }
 
+// Set latency, in ticks (normally from ping echoes).
+void Client::setLatency(float ticks) {
+    latency = ticks;
+}
+
 int Client::eventNetworkCreate(const df::EventNetworkCreate* p_en) {
 
+    PROFILE_SCOPE(PROFILE_NETWORK);
+
   
     df::Object* p_o = p_en->getObject();
 
-    if (dynamic_cast<Fruit*>(p_o)) {
-        for (int i = 0; i < latency; i++) {
-            df::Vector new_pos = p_o->predictPosition();
-            LM.writeLog(1, "Client::eventNetworkCreate(): Latency: %d tick, Predict next position: (%f, %f)",
-                i, new_pos.getX(), new_pos.getY());
-            WM.moveObject(p_o, new_pos); 
-        }
+    // Catch Fruit up by latency, in one move.  Each tick WorldManager
+    // adds acceleration to velocity, then velocity to position, so
+    // after n ticks: p + n v + a n(n+1)/2, with velocity v + n a.
+    if (stringToGameType(p_o->getType()) == FRUIT_TYPE && latency > 0) {
+        float n = latency;
+        df::Vector p = p_o->getPosition();
+        df::Vector v = p_o->getVelocity();
+        df::Vector a = p_o->getAcceleration();
+        float k = n * (n + 1) / 2;
+        df::Vector new_pos(p.getX() + n * v.getX() + k * a.getX(),
+            p.getY() + n * v.getY() + k * a.getY());
+        if (a.getX() != 0 || a.getY() != 0)
+            p_o->setVelocity(df::Vector(v.getX() + n * a.getX(), v.getY() + n * a.getY()));
+        LM.writeLog(1, "Client::eventNetworkCreate(): Latency: %.2f ticks, Predict position: (%f, %f)",
+            latency, new_pos.getX(), new_pos.getY());
+        WM.moveObject(p_o, new_pos);
     }
     LM.writeLog("Client::eventNetworkCreate(): Handled object ID: %d.", p_o->getId());
 
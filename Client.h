@@ -14,12 +14,19 @@
 #include "EventNetworkCreate.h"
 #include "EventStep.h"
 
+// Game includes.
+#include "InputPacket.h"
+#include "InputSampler.h"
+#include "LatencyEstimator.h"
+#include "Profiler.h"
+
 const std::string CLIENT_STRING = "Client";
 
 class Client : public df::NetworkNode {
 
  public:
-  Client();
+  // Mouse sampled input_rate_hz times per second (if window).
+  Client(int input_rate_hz = INPUT_RATE_HZ);
 
   // Handle event.
   int eventHandler(const df::Event *p_e) override;
@@ -33,10 +40,22 @@ class Client : public df::NetworkNode {
 
   int eventNetworkCreate(const df::EventNetworkCreate* p_en);
 
+  // Set latency, in ticks (normally from ping echoes).
+  void setLatency(float ticks);
+
  private:
 	 int ping_count;
-	 int latency;
+	 int ping_seq;
+	 float latency;                    // estimated RTT, in ticks
+	 LatencyEstimator latency_estimator; // from pings and server times
 	 int client_id;
+	 int input_ticks;                  // ticks since input latency logged
+	 ProfileHistogram input_latency;   // sample to send, in ns
+	 InputEncoder input_encoder;       // samples sent, with redundancy
+
+  // Send sampled mouse path: local sword follows all of it, as
+  // will server's.  Return number of samples used.
+  int sendInput();
 
   // Handle mouse event.
   int mouse(const df::EventMouse *p_e);
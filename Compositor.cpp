@@ -0,0 +1,266 @@
+//
+// Compositor.cpp
+//
+
+// System includes.
+#include <algorithm>
+#include <math.h>
+
+// Engine includes.
+#include "DisplayManager.h"
+#include "LogManager.h"
+#include "utility.h"
+
+// Game includes.
+#include "Compositor.h"
+#include "Profiler.h"
+
+Compositor *Compositor::s_p_instance = NULL;
+
+// Draw batches to game window.
+void WindowBackend::submit(const sf::VertexArray &vertices,
+			   const sf::Texture *p_texture) {
+  sf::RenderWindow *p_win = DM.getWindow();
+  if (p_win)
+    p_win -> draw(vertices, sf::RenderStates(p_texture));
+}
+
+RecordingBackend::RecordingBackend() {
+  batches = 0;
+  vertices = 0;
+  last.setPrimitiveType(sf::Quads);
+  last_texture = NULL;
+}
+
+// Keep batches in memory, for running without a display.
+void RecordingBackend::submit(const sf::VertexArray &new_vertices,
+			      const sf::Texture *p_texture) {
+  batches += 1;
+  vertices += new_vertices.getVertexCount();
+  last = new_vertices;
+  last_texture = p_texture;
+}
+
+Compositor::Compositor() {
+  setType(COMPOSITOR_STRING);
+  setSolidness(df::SPECTRAL);
+  setAltitude(COMPOSITOR_ALTITUDE);
+
+  m_width = DM.getHorizontal();
+  m_height = DM.getVertical();
+  Cell empty = {' ', 0, 0, 0};
+  m_cell.assign(m_width * m_height, empty);
+  m_prev.assign(m_width * m_height, empty);
+  m_free.reserve(COMPOSITOR_MAX_FREE);
+  m_vertices.setPrimitiveType(sf::Quads);
+  m_vertices.resize(m_width * m_height * 4);
+
+  m_char_size = (unsigned int) df::charHeight();
+  m_cell_w = df::charWidth();
+  m_cell_h = df::charHeight();
+  m_font_state = 0;
+  m_p_backend = &m_window;
+  m_changed = 0;
+}
+
+Compositor::~Compositor() {
+  s_p_instance = NULL;
+}
+
+// Get the one and only Compositor (created on first use).
+Compositor &Compositor::getInstance() {
+  if (!s_p_instance)
+    s_p_instance = new Compositor();
+  return *s_p_instance;
+}
+
+// Load font on first use.  Return true if loaded.
+bool Compositor::loadFont() {
+  if (m_font_state == 0) {
+    m_font_state = m_font.loadFromFile(df::FONT_FILE_DEFAULT) ? 1 : -1;
+    if (m_font_state < 0)
+      LM.writeLog("Compositor::loadFont(): Error! Unable to load %s.",
+		  df::FONT_FILE_DEFAULT.c_str());
+  }
+  return m_font_state > 0;
+}
+
+// Put character at world position into grid (rounded to cell).
+// Later puts to same cell win.
+void Compositor::put(df::Vector world_pos, char ch, df::Color color) {
+  unsigned char r, g, b;
+  df::colorToRGB(color, r, g, b);
+  put(world_pos, ch, r, g, b);
+}
+
+void Compositor::put(df::Vector world_pos, char ch,
+		     unsigned char r, unsigned char g, unsigned char b) {
+  df::Vector view = df::worldToView(world_pos);
+  int x = (int) floorf(view.getX() + 0.5f);
+  int y = (int) floorf(view.getY() + 0.5f);
+  if (x < 0 || x >= m_width || y < 0 || y >= m_height)
+    return;
+  Cell &c = m_cell[y * m_width + x];
+  c.ch = ch;
+  c.r = r;
+  c.g = g;
+  c.b = b;
+}
+
+// Put baked sprite frame (its opaque runs), centered at world position.
+void Compositor::putFrame(const BakedSprite *p_baked, int index,
+			  df::Vector world_pos) {
+
+  if (!p_baked || index < 0 || index >= p_baked -> frame_count)
+    return;
+
+  df::Vector view = df::worldToView(world_pos);
+  int cx = (int) floorf(view.getX() + 0.5f);
+  int cy = (int) floorf(view.getY() + 0.5f);
+
+  const GlyphRun *p_run = p_baked -> getRuns(index);
+  int count = p_baked -> getRunCount(index);
+  for (int i=0; i<count; i++, p_run++) {
+    int y = cy + p_run -> y;
+    if (y < 0 || y >= m_height)
+      continue;
+    int x = cx + p_run -> x;
+    const char *p_ch = p_baked -> chars.data() + p_run -> start;
+    Cell *p_cell = &m_cell[y * m_width];
+    for (int k=0; k<p_run -> length; k++, x++) {
+      if (x < 0 || x >= m_width)
+	continue;
+      Cell &c = p_cell[x];
+      c.ch = p_ch[k];
+      c.r = p_run -> r;
+      c.g = p_run -> g;
+      c.b = p_run -> b;
+    }
+  }
+}
+
+// Put character off grid, at world position with rotation (degrees).
+void Compositor::putFree(df::Vector world_pos, char ch, df::Color color,
+			 float rotation) {
+  if ((int) m_free.size() == COMPOSITOR_MAX_FREE)
+    return;
+  df::Vector view = df::worldToView(world_pos);
+  FreeGlyph f;
+  f.x = view.getX();
+  f.y = view.getY();
+  f.rotation = rotation;
+  f.ch = ch;
+  df::colorToRGB(color, f.r, f.g, f.b);
+  m_free.push_back(f);
+}
+
+// Set quad at p_quad for character ch with color, centered at
+// pixel (cx, cy), rotated by degrees.
+void Compositor::setQuad(sf::Vertex *p_quad, char ch, sf::Color color,
+			 float cx, float cy, float rotation) {
+
+  // Empty: degenerate quad, draws nothing.
+  if (ch == ' ') {
+    for (int i=0; i<4; i++)
+      p_quad[i] = sf::Vertex(sf::Vector2f(cx, cy), sf::Color::Transparent);
+    return;
+  }
+
+  // Corners relative to cell center, and matching atlas corners.
+  float left = -m_cell_w / 2, top = -m_cell_h / 2;
+  float width = m_cell_w, height = m_cell_h;
+  sf::FloatRect tex(0, 0, 0, 0);
+  if (m_p_backend -> wantsTexture() && loadFont()) {
+    const sf::Glyph &glyph = m_font.getGlyph((sf::Uint32) (unsigned char) ch,
+					     m_char_size, false);
+    left = (glyph.advance - m_cell_w) / 2 + glyph.bounds.left;
+    top = m_cell_h * (COMPOSITOR_BASELINE - 0.5f) + glyph.bounds.top;
+    width = glyph.bounds.width;
+    height = glyph.bounds.height;
+    tex = sf::FloatRect((float) glyph.textureRect.left,
+			(float) glyph.textureRect.top,
+			(float) glyph.textureRect.width,
+			(float) glyph.textureRect.height);
+  }
+
+  sf::Vector2f corner[4] = {
+    sf::Vector2f(left, top),
+    sf::Vector2f(left + width, top),
+    sf::Vector2f(left + width, top + height),
+    sf::Vector2f(left, top + height),
+  };
+  sf::Vector2f tex_corner[4] = {
+    sf::Vector2f(tex.left, tex.top),
+    sf::Vector2f(tex.left + tex.width, tex.top),
+    sf::Vector2f(tex.left + tex.width, tex.top + tex.height),
+    sf::Vector2f(tex.left, tex.top + tex.height),
+  };
+
+  float c = 1.0f, s = 0.0f;
+  if (rotation != 0.0f) {
+    c = cosf(rotation * 3.14159265f / 180.0f);
+    s = sinf(rotation * 3.14159265f / 180.0f);
+  }
+  for (int i=0; i<4; i++) {
+    float x = corner[i].x * c - corner[i].y * s;
+    float y = corner[i].x * s + corner[i].y * c;
+    p_quad[i] = sf::Vertex(sf::Vector2f(cx + x, cy + y), color, tex_corner[i]);
+  }
+}
+
+// Diff grid, submit frame as one batch and clear for next frame.
+// Return 0 if ok, else -1.
+int Compositor::draw() {
+
+  PROFILE_SCOPE(PROFILE_DRAW);
+
+  // Rebuild quads only for cells that changed since last frame.
+  int cells = m_width * m_height;
+  m_changed = 0;
+  for (int i=0; i<cells; i++) {
+    if (m_cell[i] == m_prev[i])
+      continue;
+    const Cell &cell = m_cell[i];
+    float cx = (i % m_width + 0.5f) * m_cell_w;
+    float cy = (i / m_width + 0.5f) * m_cell_h;
+    setQuad(&m_vertices[i * 4], cell.ch, sf::Color(cell.r, cell.g, cell.b),
+	    cx, cy, 0.0f);
+    m_changed += 1;
+  }
+
+  // Free glyphs move every frame, so always rebuilt, after grid.
+  m_vertices.resize((cells + m_free.size()) * 4);
+  for (int i=0; i<(int) m_free.size(); i++) {
+    const FreeGlyph &f = m_free[i];
+    setQuad(&m_vertices[(cells + i) * 4], f.ch, sf::Color(f.r, f.g, f.b),
+	    (f.x + 0.5f) * m_cell_w, (f.y + 0.5f) * m_cell_h, f.rotation);
+  }
+
+  const sf::Texture *p_texture = NULL;
+  if (m_p_backend -> wantsTexture() && loadFont())
+    p_texture = &m_font.getTexture(m_char_size);
+  m_p_backend -> submit(m_vertices, p_texture);
+
+  // Next frame starts empty; this one is what it diffs against.
+  m_prev.swap(m_cell);
+  Cell empty = {' ', 0, 0, 0};
+  std::fill(m_cell.begin(), m_cell.end(), empty);
+  m_free.clear();
+  m_vertices.resize(cells * 4);
+
+  return 0;
+}
+
+// Set backend (NULL for window).
+void Compositor::setBackend(CompositorBackend *p_backend) {
+  m_p_backend = p_backend ? p_backend : &m_window;
+
+  // Quads from other backend may lack atlas coordinates: rebuild all.
+  Cell unset = {'\0', 0, 0, 0};
+  std::fill(m_prev.begin(), m_prev.end(), unset);
+}
+
+// Get number of cells rebuilt last frame.
+int Compositor::getChanged() const {
+  return m_changed;
+}
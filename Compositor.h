@@ -0,0 +1,161 @@
+//
+// Compositor.h
+//
+// Character framebuffer for game drawing.  Instead of one DM.drawCh()
+// (an sf::Text set up and drawn) per character, objects put characters
+// into a grid of cells, one per window space.  Each frame the grid is
+// diffed against the previous one and only changed cells rebuild
+// their quad; then the whole grid, plus any "free" glyphs (rotated or
+// between cells, like explosion debris), goes out as one vertex array
+// textured from the font's glyph atlas.
+//
+// Output goes to a backend: the window, or a recording backend that
+// keeps batches in memory, so batching runs without a display.
+//
+// Objects putting into the grid must be below COMPOSITOR_ALTITUDE,
+// so they draw (put) before the Compositor draws the frame.
+//
+
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+// System includes.
+#include <vector>
+
+// SFML includes.
+#include <SFML/Graphics.hpp>
+
+// Engine includes.
+#include "Color.h"
+#include "Object.h"
+#include "Vector.h"
+
+// Game includes.
+#include "SpriteBake.h"
+
+const std::string COMPOSITOR_STRING = "Compositor";
+
+// Compositor settings.
+const int COMPOSITOR_ALTITUDE = 4;           // df::MAX_ALTITUDE
+const int FOREGROUND_ALTITUDE = 3;           // highest for putting objects
+const int COMPOSITOR_MAX_FREE = 4096;        // max free glyphs per frame
+const float COMPOSITOR_BASELINE = 0.8f;      // baseline, fraction of cell
+
+// One grid cell.
+struct Cell {
+  char ch;                                   // ' ' if empty
+  unsigned char r, g, b;
+
+  bool operator==(const Cell &c) const {
+    return ch == c.ch && r == c.r && g == c.g && b == c.b;
+  }
+  bool operator!=(const Cell &c) const { return !(*this == c); }
+};
+
+// Character not on grid: fractional position and rotation.
+struct FreeGlyph {
+  float x, y;                                // view position, in spaces
+  float rotation;                            // degrees
+  char ch;
+  unsigned char r, g, b;
+};
+
+// Where batches go.
+class CompositorBackend {
+ public:
+  virtual ~CompositorBackend() {}
+
+  // Submit one batch of textured quads.
+  virtual void submit(const sf::VertexArray &vertices,
+		      const sf::Texture *p_texture) = 0;
+
+  // Return true if quads need glyph atlas texture coordinates.
+  virtual bool wantsTexture() const { return true; }
+};
+
+// Draw batches to game window.
+class WindowBackend : public CompositorBackend {
+ public:
+  void submit(const sf::VertexArray &vertices,
+	      const sf::Texture *p_texture) override;
+};
+
+// Keep batches in memory, for running without a display.
+class RecordingBackend : public CompositorBackend {
+ public:
+  int batches;                               // batches submitted
+  long long vertices;                        // vertices over all batches
+  sf::VertexArray last;                      // copy of last batch
+  const sf::Texture *last_texture;           // texture of last batch
+
+  RecordingBackend();
+  void submit(const sf::VertexArray &vertices,
+	      const sf::Texture *p_texture) override;
+  bool wantsTexture() const override { return false; }
+};
+
+// Two-letter acronym for easier access to compositor.
+#define CM Compositor::getInstance()
+
+class Compositor : public df::Object {
+
+ private:
+  static Compositor *s_p_instance;           // the one and only
+  int m_width, m_height;                     // grid size, in cells
+  std::vector<Cell> m_cell;                  // this frame
+  std::vector<Cell> m_prev;                  // last frame
+  std::vector<FreeGlyph> m_free;             // this frame
+  sf::VertexArray m_vertices;                // 4 per cell, then free
+  sf::Font m_font;                           // glyph atlas source
+  unsigned int m_char_size;                  // font size, in pixels
+  float m_cell_w, m_cell_h;                  // cell size, in pixels
+  int m_font_state;                          // 0 not tried, 1 ok, -1 failed
+  WindowBackend m_window;                    // default backend
+  CompositorBackend *m_p_backend;            // current backend
+  int m_changed;                             // cells rebuilt last frame
+
+  Compositor();                              // Private, use getInstance().
+  Compositor(Compositor const&);             // Don't allow copy.
+  void operator=(Compositor const&);         // Don't allow assignment.
+
+  // Load font on first use.  Return true if loaded.
+  bool loadFont();
+
+  // Set quad at p_quad for character ch with color, centered at
+  // pixel (cx, cy), rotated by degrees.
+  void setQuad(sf::Vertex *p_quad, char ch, sf::Color color,
+	       float cx, float cy, float rotation);
+
+ public:
+
+  // Get the one and only Compositor (created on first use).
+  static Compositor &getInstance();
+
+  // Destructor.
+  ~Compositor();
+
+  // Put character at world position into grid (rounded to cell).
+  // Later puts to same cell win.
+  void put(df::Vector world_pos, char ch, df::Color color);
+  void put(df::Vector world_pos, char ch,
+	   unsigned char r, unsigned char g, unsigned char b);
+
+  // Put baked sprite frame (its opaque runs), centered at world position.
+  void putFrame(const BakedSprite *p_baked, int index, df::Vector world_pos);
+
+  // Put character off grid, at world position with rotation (degrees).
+  void putFree(df::Vector world_pos, char ch, df::Color color,
+	       float rotation);
+
+  // Diff grid, submit frame as one batch and clear for next frame.
+  // Return 0 if ok, else -1.
+  int draw() override;
+
+  // Set backend (NULL for window).
+  void setBackend(CompositorBackend *p_backend);
+
+  // Get number of cells rebuilt last frame.
+  int getChanged() const;
+};
+
+#endif // COMPOSITOR_H
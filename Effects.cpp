@@ -0,0 +1,201 @@
+//
+// Effects.cpp
+//
+
+// System includes.
+#include <math.h>
+#include <stdlib.h>		// for rand()
+
+// Engine includes.
+#include "Debris.h"
+#include "DisplayManager.h"
+#include "EventStep.h"
+#include "GameManager.h"
+#include "LogManager.h"
+#include "WorldManager.h"
+
+// Game includes.
+#include "Compositor.h"
+#include "Effects.h"
+#include "FrameBudget.h"
+#include "Profiler.h"
+#include "SpriteBake.h"
+
+Effects *Effects::s_p_instance = NULL;
+
+Effects::Effects() {
+  setType(EFFECTS_STRING);
+  setSolidness(df::SPECTRAL);
+  setAltitude(FOREGROUND_ALTITUDE);
+  registerInterest(df::STEP_EVENT);
+  m_count = 0;
+  m_dropped = 0;
+}
+
+Effects::~Effects() {
+  s_p_instance = NULL;
+}
+
+// Get the one and only Effects (created on first use).
+Effects &Effects::getInstance() {
+  if (!s_p_instance)
+    s_p_instance = new Effects();
+  return *s_p_instance;
+}
+
+// Handle event.
+// Return 0 if ignored, else 1.
+int Effects::eventHandler(const df::Event *p_e) {
+
+  // Step event.
+  if (p_e->getType() == df::STEP_EVENT)
+    return step();
+
+  // If get here, have ignored this event.
+  return 0;
+}
+
+// Move, spin and age all particles.
+int Effects::step() {
+
+  if (m_count == 0)
+    return 1;
+
+  int i = 0;
+  while (i < m_count) {
+    EffectParticle &p = m_pool[i];
+
+    p.age -= 1;
+    if (p.age <= 0) {
+      // Expired, so replace with last.
+      p = m_pool[m_count - 1];
+      m_count -= 1;
+      continue;
+    }
+
+    p.x += p.dx;
+    p.y += p.dy;
+    p.rotation += p.rotate;
+    i += 1;
+  }
+
+  if (GM.getStepCount() % EFFECTS_REPORT_TICKS == 0)
+    report();
+
+  // Handled.
+  return 1;
+}
+
+// Draw all live particles.
+int Effects::draw() {
+
+  PROFILE_SCOPE(PROFILE_DRAW);
+  for (int i=0; i<m_count; i++) {
+    const EffectParticle &p = m_pool[i];
+    if (p.rotation == 0.0f)
+      CM.put(df::Vector(p.x, p.y), p.ch, p.color);
+    else
+      CM.putFree(df::Vector(p.x, p.y), p.ch, p.color, p.rotation);
+  }
+  return 0;
+}
+
+// Add particle for each visible character of sprite frame, keeping
+// about fraction (0, 1] of them.
+// Return number of particles added.
+int Effects::addFrame(const df::Sprite *p_sprite, int index,
+		      df::Vector position, int age, float speed,
+		      float rotate, float fraction) {
+
+  const BakedSprite *p_baked = bakeSprite(p_sprite);
+  if (!p_baked || index < 0 || index >= p_baked -> frame_count)
+    return 0;
+  df::Color color = p_sprite -> getColor();
+
+  int added = 0;
+  const GlyphRun *p_run = p_baked -> getRuns(index);
+  int runs = p_baked -> getRunCount(index);
+  for (int i=0; i<runs; i++, p_run++) {
+    for (int k=0; k<p_run -> length; k++) {
+
+      char ch = p_baked -> chars[p_run -> start + k];
+      int x = p_run -> x + k;   // offset from center
+      int y = p_run -> y;
+
+      if (fraction < 1.0f && rand() % 100 >= (int) (fraction * 100))
+	continue;
+
+      if (m_count == EFFECTS_MAX) {
+	m_dropped += 1;
+	continue;
+      }
+
+      EffectParticle &p = m_pool[m_count++];
+      p.x = position.getX() + x;
+      p.y = position.getY() + y;
+      p.ch = ch;
+      p.color = color;
+      p.age = age;
+      p.rotation = 0.0f;
+
+      // Fly outward from center, spinning either way.
+      float dx = (float) x;
+      float dy = (float) y;
+      float len = sqrtf(dx*dx + dy*dy);
+      if (len == 0.0f) {
+	dx = (float) (rand() % 3 - 1);
+	dy = (float) (rand() % 3 - 1);
+	len = 1.0f;
+      }
+      p.dx = speed * dx / len;
+      p.dy = speed * dy / len;
+      p.rotate = (rand() % 2) ? rotate : -rotate;
+      added += 1;
+    }
+  }
+
+  return added;
+}
+
+// "Explode" a sprite frame into debris, thinned by frame budget.
+// Return 0 if ok, else -1.
+int Effects::explode(const df::Sprite *p_sprite, int index,
+		     df::Vector position, int age, float speed,
+		     float rotate) {
+  if (!p_sprite)
+    return -1;
+  addFrame(p_sprite, index, position, age, speed, rotate,
+	   FB.getExplosionFraction());
+  return 0;
+}
+
+// Show sprite frame, unmoving, for age ticks.
+// Return 0 if ok, else -1.
+int Effects::popup(const df::Sprite *p_sprite, int index,
+		   df::Vector position, int age) {
+  if (!p_sprite)
+    return -1;
+  addFrame(p_sprite, index, position, age, 0.0f, 0.0f);
+  return 0;
+}
+
+// "Shake" window with severity scale (pixels) and duration (frames).
+void Effects::shake(int scale_x, int scale_y, int duration) {
+  DM.shake(scale_x, scale_y, duration);
+}
+
+// Get number of live particles.
+int Effects::getCount() const {
+  return m_count;
+}
+
+// Write memory report line, every EFFECTS_REPORT_TICKS: pooled bytes against
+// what the same particles cost as engine Debris Objects.
+void Effects::report() const {
+  LM.writeMyLog(EFFECTS_LOG,
+		"step %d: particles %d, pool bytes %d, as Debris Objects %d, dropped %d",
+		GM.getStepCount(), m_count,
+		(int) (m_count * sizeof(EffectParticle)),
+		(int) (m_count * sizeof(df::Debris)),
+		m_dropped);
+}
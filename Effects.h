@@ -0,0 +1,98 @@
+//
+// Effects.h
+//
+// Non-interactive visual effects (explosion debris, kudos popups,
+// screen shake).  Effect particles are plain structs in a fixed pool,
+// so they have no event registration and are not in the scene graph.
+// Only the Effects Object itself is.
+//
+
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+// Engine includes.
+#include "Color.h"
+#include "Object.h"
+#include "Sprite.h"
+#include "Vector.h"
+
+const std::string EFFECTS_STRING = "Effects";
+
+// Effects settings.
+const int EFFECTS_MAX = 4096;  // max live particles
+const std::string EFFECTS_LOG = "effects.log";
+const int EFFECTS_REPORT_TICKS = 30;  // ticks between reports (1 second)
+
+// Single effect particle.
+struct EffectParticle {
+  float x, y;                  // position, in spaces
+  float dx, dy;                // velocity, in spaces/tick
+  float rotation;              // current rotation, in degrees
+  float rotate;                // rotation per tick, in degrees
+  int age;                     // ticks left to live
+  char ch;                     // character to draw
+  df::Color color;             // character color
+};
+
+// Two-letter acronym for easier access to effects.
+#define FX Effects::getInstance()
+
+class Effects : public df::Object {
+
+ private:
+  static Effects *s_p_instance;        // the one and only Effects
+  EffectParticle m_pool[EFFECTS_MAX];  // live particles are [0, m_count)
+  int m_count;                         // number of live particles
+  int m_dropped;                       // particles dropped, pool full
+
+  Effects();                           // Private, use getInstance().
+  Effects(Effects const&);             // Don't allow copy.
+  void operator=(Effects const&);      // Don't allow assignment.
+
+  // Add particle for each visible character of sprite frame, keeping
+  // about fraction (0, 1] of them.
+  // Return number of particles added.
+  int addFrame(const df::Sprite *p_sprite, int index, df::Vector position,
+	       int age, float speed, float rotate, float fraction = 1.0f);
+
+  // Handle step event.
+  int step();
+
+  // Write memory report line, every EFFECTS_REPORT_TICKS.
+  void report() const;
+
+ public:
+
+  // Get the one and only Effects (created on first use).
+  static Effects &getInstance();
+
+  // Destructor.
+  ~Effects();
+
+  // Handle events.
+  int eventHandler(const df::Event *p_e) override;
+
+  // Draw all live particles.
+  int draw() override;
+
+  // "Explode" a sprite frame into debris, thinned by frame budget.
+  // age - how long it should last (in ticks)
+  // speed - speed (in spaces per tick)
+  // rotate - degrees to spin (per tick)
+  // Return 0 if ok, else -1.
+  int explode(const df::Sprite *p_sprite, int index, df::Vector position,
+	      int age, float speed, float rotate);
+
+  // Show sprite frame, unmoving, for age ticks.
+  // Return 0 if ok, else -1.
+  int popup(const df::Sprite *p_sprite, int index, df::Vector position,
+	    int age);
+
+  // "Shake" window with severity scale (pixels) and duration (frames).
+  void shake(int scale_x, int scale_y, int duration);
+
+  // Get number of live particles.
+  int getCount() const;
+};
+
+#endif // EFFECTS_H
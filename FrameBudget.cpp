@@ -0,0 +1,100 @@
+//
+// FrameBudget.cpp
+//
+
+// Engine includes.
+#include "GameManager.h"
+#include "LogManager.h"
+
+// Game includes.
+#include "FrameBudget.h"
+#include "Trail.h"
+
+FrameBudget::FrameBudget() {
+  m_quality = 1.0f;
+  m_frame_ms = 0.0f;
+  m_hold = 0;
+  m_good = 0;
+  m_started = false;
+}
+
+// Get the one and only instance of the FrameBudget.
+FrameBudget &FrameBudget::getInstance() {
+  static FrameBudget frame_budget;
+  return frame_budget;
+}
+
+// Call once per client step to watch frame time and adjust quality.
+// Game loop sleeps off any time left in frame, so time between steps
+// is target frame time unless frame work overran it.
+void FrameBudget::step() {
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  if (!m_started) {
+    m_started = true;
+    m_last = now;
+    m_frame_ms = (float) GM.getFrameTime();
+    return;
+  }
+  float frame_ms = std::chrono::duration<float, std::milli>(now - m_last).count();
+  m_last = now;
+  m_frame_ms += BUDGET_GAIN * (frame_ms - m_frame_ms);
+
+  float target_ms = (float) GM.getFrameTime();
+  if (m_hold > 0)
+    m_hold -= 1;
+
+  // Over budget: cut effects.
+  if (m_frame_ms > target_ms * BUDGET_OVER) {
+    m_good = 0;
+    if (m_hold == 0 && m_quality > BUDGET_MIN_QUALITY) {
+      setQuality(m_quality - BUDGET_DOWN);
+      m_hold = BUDGET_HOLD_TICKS;
+    }
+    return;
+  }
+
+  // Within budget long enough: restore some effects.
+  if (m_frame_ms < target_ms * BUDGET_UNDER) {
+    m_good += 1;
+    if (m_good >= BUDGET_RECOVER_TICKS && m_quality < 1.0f) {
+      setQuality(m_quality + BUDGET_UP);
+      m_good = 0;
+    }
+  } else
+    m_good = 0;
+}
+
+// Change quality, logging why.
+void FrameBudget::setQuality(float new_quality) {
+  if (new_quality < BUDGET_MIN_QUALITY)
+    new_quality = BUDGET_MIN_QUALITY;
+  if (new_quality > 1.0f)
+    new_quality = 1.0f;
+  LM.writeLog("FrameBudget::setQuality(): step %d, frame %.1f ms (target %d ms): quality %.0f%% -> %.0f%%",
+	      GM.getStepCount(), m_frame_ms, GM.getFrameTime(),
+	      m_quality * 100, new_quality * 100);
+  m_quality = new_quality;
+}
+
+// Get quality, (0, 1].
+float FrameBudget::getQuality() const {
+  return m_quality;
+}
+
+// Get trail samples per space.
+int FrameBudget::getTrailDensity() const {
+  int density = (int) (TRAIL_DENSITY * m_quality + 0.5f);
+  return density < 1 ? 1 : density;
+}
+
+// Get fraction of explosion particles to keep, (0, 1].
+float FrameBudget::getExplosionFraction() const {
+  return m_quality;
+}
+
+// Get max concurrent sound voices.
+int FrameBudget::getMaxVoices() const {
+  int voices = (int) (BUDGET_MAX_VOICES * m_quality + 0.5f);
+  return voices < 1 ? 1 : voices;
+}
@@ -0,0 +1,69 @@
+//
+// FrameBudget.h
+//
+// Client frame-time governor for effects.  Watches time between
+// steps and scales a quality factor in [BUDGET_MIN_QUALITY, 1]: down
+// quickly when frames run over the target, back up slowly when they
+// are within it.  Trail density, explosion particles and concurrent
+// sound voices all scale by it.  Quality changes are logged.
+//
+
+#ifndef FRAME_BUDGET_H
+#define FRAME_BUDGET_H
+
+// System includes.
+#include <chrono>
+
+// FrameBudget settings.
+const float BUDGET_OVER = 1.05f;         // frame/target time to lower quality
+const float BUDGET_UNDER = 1.01f;        // frame/target time to raise quality
+const float BUDGET_GAIN = 0.125f;        // frame time smoothing
+const float BUDGET_DOWN = 0.1f;          // quality step down
+const float BUDGET_UP = 0.05f;           // quality step up
+const float BUDGET_MIN_QUALITY = 0.2f;   // lowest quality
+const int BUDGET_HOLD_TICKS = 10;        // min ticks between changes
+const int BUDGET_RECOVER_TICKS = 60;     // ticks within target to raise
+const int BUDGET_MAX_VOICES = 8;         // sound voices at full quality
+
+// Two-letter acronym for easier access to frame budget.
+#define FB FrameBudget::getInstance()
+
+class FrameBudget {
+
+ private:
+  FrameBudget();                         // Private since a singleton.
+  FrameBudget(FrameBudget const&);       // Don't allow copy.
+  void operator=(FrameBudget const&);    // Don't allow assignment.
+
+  float m_quality;                       // current quality, (0, 1]
+  float m_frame_ms;                      // smoothed time between steps
+  int m_hold;                            // ticks until may change again
+  int m_good;                            // consecutive ticks within target
+  bool m_started;                        // true once first step seen
+  std::chrono::steady_clock::time_point m_last; // time of last step
+
+  // Change quality, logging why.
+  void setQuality(float new_quality);
+
+ public:
+
+  // Get the one and only instance of the FrameBudget.
+  static FrameBudget &getInstance();
+
+  // Call once per client step to watch frame time and adjust quality.
+  void step();
+
+  // Get quality, (0, 1].
+  float getQuality() const;
+
+  // Get trail samples per space.
+  int getTrailDensity() const;
+
+  // Get fraction of explosion particles to keep, (0, 1].
+  float getExplosionFraction() const;
+
+  // Get max concurrent sound voices.
+  int getMaxVoices() const;
+};
+
+#endif // FRAME_BUDGET_H
@@ -2,18 +2,22 @@
 // Fruit.cpp
 //
 
+// System includes.
+#include <math.h>
+
 // Engine includes.
 #include "EventCollision.h"
-#include "EventOut.h"
-#include "EventView.h"
 #include "GameManager.h"
 #include "LogManager.h"
 #include "NetworkManager.h"
 #include "WorldManager.h"
 
 // Game includes.
+#include "Compositor.h"
+#include "Effects.h"
 #include "Fruit.h"
-#include "Points.h"
+#include "Profiler.h"
+#include "Scoreboard.h"
 #include "Server.h"
 #include "Sword.h"
 #include "util.h"
@@ -24,8 +28,39 @@ Fruit::Fruit(std::string name) {
   if (setSprite(name) != 0)
     LM.writeLog("Fruit::Fruit(): Error! Unable to find sprite: %s",
 		name.c_str());
-  m_first_out = true; // To ignore first time outofbounds.
-  setSolidness(df::SOFT);
+  m_out_step = -1;
+  m_done = false;
+  m_p_baked = bakeSprite(getAnimation().getSprite());
+  m_frame = 0;
+  m_slowdown_count = 0;
+  setSolidness(df::SPECTRAL);
+  Registry<Fruit>::insert(this, FRUIT_TYPE);
+}
+
+// Draw current baked frame through Compositor and advance animation
+// (as Animation::draw() does, but without copying Animation).
+int Fruit::draw() {
+
+  // Server has no window to draw to.
+  if (NM.isServer())
+    return 0;
+
+  PROFILE_SCOPE(PROFILE_DRAW);
+
+  if (!m_p_baked)
+    return -1;
+  CM.putFrame(m_p_baked, m_frame, getPosition());
+
+  // Slowdown 0 means stopped.
+  if (m_p_baked -> slowdown == 0)
+    return 0;
+  m_slowdown_count += 1;
+  if (m_slowdown_count >= m_p_baked -> slowdown) {
+    m_slowdown_count = 0;
+    m_frame = (m_frame + 1) % m_p_baked -> frame_count;
+  }
+
+  return 0;
 }
 
 // Handle event.
@@ -35,65 +70,47 @@ int Fruit::eventHandler(const df::Event *p_e) {
   if (p_e -> getType() == df::COLLISION_EVENT && NM.isServer())
     return collide((df::EventCollision *) p_e);
 
-  // Step event.
-  if (p_e -> getType() == df::OUT_EVENT && NM.isServer())
-    return out((df::EventOut *) p_e);
-
   // Not handled.
   return 0;
 }
 
-// Handle out events.
-int Fruit::out(const df::EventOut *p_e) {
+// Fruit left world unsliced: all players lose points.
+// Return 0 if ok, -1 if already sliced or missed.
+int Fruit::miss() {
 
-  if (m_first_out) { // Ignore first out.
-    m_first_out = false;
-    return 1;
-  }
+  if (m_done)
+    return -1;
+  m_done = true;
 
   // All players lose points for each miss.
-  for (int i=0; i<NM.getNumConnections(); i++) {
-    std::string s = "Player ";
-    s += df::toString(i);
-    s += ":";
-    df::EventView ev(s, -25, true);
-    WM.onEvent(&ev);
-  }
+  SB.addAll(MISS_POINTS);
 
   WM.markForDelete(this);
 
   // Send DELETE message to all clients.
-  if (NM.isServer()) {
-    LM.writeLog(1, "Fruit::out(): Sending DELETE message....");
-    SERVER -> sendMessage(df::MessageType::DELETE_OBJECT, this);
-  }
+  if (NM.isServer())
+    SERVER -> deleteObject(this);
 
-  // Handled.
-  return 1;
+  return 0;
 }
 
 // Handle collision events.
+// Return 1 if sliced, else 0 (already sliced or missed).
 int Fruit::collide(const df::EventCollision *p_e) {
 
-  if (p_e -> getObject1() -> getType() == "Sword") {
+  if (m_done || !Registry<Sword>::contains(p_e -> getObject1()))
+    return 0;
+  m_done = true;
 
-    // Add points.
-    int sock_index = ((Sword *) (p_e -> getObject1())) -> getSocketIndex();
-    std::string s = "Player ";
-    s += df::toString(sock_index);
-    s += ":";
-    df::EventView ev(s, 10, true);
-    WM.onEvent(&ev);
+  // Add points.
+  int sock_index = ((Sword *) (p_e -> getObject1())) -> getSocketIndex();
+  SB.add(sock_index, SLICE_POINTS);
 
-    WM.markForDelete(this);
-
-    // Send DELETE message to all clients.
-    if (NM.isServer()) {
-      LM.writeLog(1, "Fruit::collide(): Sending DELETE message....");
-      SERVER -> sendMessage(df::MessageType::DELETE_OBJECT, this);
-    }
+  WM.markForDelete(this);
 
-  }
+  // Send DELETE message to all clients.
+  if (NM.isServer())
+    SERVER -> deleteObject(this);
 
   // Handled.
   return 1;
@@ -102,16 +119,18 @@ int Fruit::collide(const df::EventCollision *p_e) {
 // Destructor.
 Fruit::~Fruit() {
 
-  // If inside the game world and engine not shutting down,
+  Registry<Fruit>::remove(this);
+
+  // If client, inside the game world and engine not shutting down,
   // create explosion and play sound.
-  if (df::boxContainsPosition(WM.getBoundary(), getPosition()) &&
+  if (NM.isServer() == false &&
+      df::boxContainsPosition(WM.getBoundary(), getPosition()) &&
       GM.getGameOver() == false) {
-    df::explode(getAnimation().getSprite(), getAnimation().getIndex(), getPosition(),
-                EXPLOSION_AGE, EXPLOSION_SPEED, EXPLOSION_ROTATE);
+    FX.explode(getAnimation().getSprite(), m_frame, getPosition(),
+               EXPLOSION_AGE, EXPLOSION_SPEED, EXPLOSION_ROTATE);
 
     // Play "splat" sound.
-    std::string sound = "splat-" + std::to_string(rand()%6 + 1);
-    play_sound(sound);
+    play_sound(SOUND_SPLAT + rand() % NUM_SPLATS);
   }
 }
 
@@ -168,46 +187,35 @@ void Fruit::start(float speed) {
   vel.normalize();
   setDirection(vel);
   setSpeed(speed);
-}
-
-int Fruit::serialize(std::stringstream *p_ss, unsigned int attr) {
-
-  LM.writeLog(20, "Fruit::serialize(): attr is %s",
-	      df::maskToString(attr).c_str());
 
-  // Serialize parent first. 
-  if (Object::serialize(p_ss, attr))
-    LM.writeLog(20, "Fruit::serialize(): error calling Object serialize");
-
-  // Serialize remaining attributes.
-  p_ss->write(reinterpret_cast<char*>(&m_first_out), sizeof(m_first_out));
-
-  if (p_ss->good())
-    return 0;  // All is well.
+  // Compute when trailing edge of box passes far side of world,
+  // on whichever axis is first.  Fruit never turn, so this holds.
+  df::Box box = getWorldBox(this);
+  float vx = getVelocity().getX();
+  float vy = getVelocity().getY();
+  float lo_x = box.getCorner().getX();
+  float lo_y = box.getCorner().getY();
+  float hi_x = lo_x + box.getHorizontal();
+  float hi_y = lo_y + box.getVertical();
+  float out_time = -1.0f;
+  if (vx > 0.0f)
+    out_time = (world_x - lo_x) / vx;
+  else if (vx < 0.0f)
+    out_time = hi_x / -vx;
+  float t = -1.0f;
+  if (vy > 0.0f)
+    t = (world_y - lo_y) / vy;
+  else if (vy < 0.0f)
+    t = hi_y / -vy;
+  if (out_time < 0.0f || (t >= 0.0f && t < out_time))
+    out_time = t;
+  if (out_time < 0.0f) // Not moving, so never out.
+    m_out_step = -1;
   else
-    return -1; // Error.
+    m_out_step = GM.getStepCount() + (int) ceilf(out_time) + 1;
 }
 
-int Fruit::deserialize(std::stringstream *p_ss, unsigned int *p_a) {
-
-  LM.writeLog(20, "Fruit::deserialize():");
-
-  // Deserialize parent, first.
-  int ret = Object::deserialize(p_ss, p_a);
-  if (ret != 0) {
-    LM.writeLog("Fruit::deserialize(): Error calling Object::deserialize().");
-    return ret;
-  }
-
-  // Deserialize local attributes.
-  bool first_out;
-  p_ss->read(reinterpret_cast<char*>(&first_out), sizeof(first_out));
-  m_first_out = first_out;
-  LM.writeLog(20, "Fruit::deserialize(): m_first_out is %s",
-	      m_first_out ? "true" : "false");
-
-  if (p_ss->good())
-    return 0;  // All is well.
-  else
-    return -1; // Error.
+// Get step count when Fruit is fully out of world (-1 if never).
+int Fruit::getOutStep() const {
+  return m_out_step;
 }
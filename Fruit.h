@@ -11,16 +11,23 @@
 // Engine includes.
 #include "Event.h"
 #include "EventCollision.h"
-#include "EventOut.h"
 #include "Object.h"
 
-class Fruit : public df::Object {
+// Game includes.
+#include "Registry.h"
+#include "SpriteBake.h"
 
- private:
-  bool m_first_out;
+// Fruit are SPECTRAL, so moving them runs no collision queries.
+// Slicing is checked by Sword and leaving the world is computed
+// once, at start(), then retired by Grocer via outStep().
+class Fruit : public df::Object, public Registered {
 
-  // Handle out events.
-  int out(const df::EventOut *p_e);
+ private:
+  int m_out_step;	 // step count when fully out of world
+  bool m_done;		 // true once sliced or missed
+  const BakedSprite *m_p_baked; // sprite frames, as glyph runs
+  int m_frame;		 // frame being shown
+  int m_slowdown_count;	 // ticks on this frame
 
   // Handle collision events.
   int collide(const df::EventCollision *p_e);
@@ -36,21 +43,18 @@ public:
   // Handle events.
   int eventHandler(const df::Event *p_e) override;
 
+  // Draw current baked frame through Compositor and advance animation.
+  int draw() override;
+
   // Setup starting conditions.
   void start(float speed);
 
-  // Serialize modified attributes to stream.
-  // Can specify individual attribute(s) to force (modified or not).
-  // Default is only modified attributes.
-  // Clears modified bits for attributes serialized.
-  // Return 0 if ok, else -1.
-  int serialize(std::stringstream *p_ss, unsigned int attr=0) override;
-
-  // Deserialize stream to attributes and apply.
-  // p_ss - incoming stream to deserialize.
-  // p_a - outgoing bitmask of attributes modified (NULL means no outgoing).
-  // Return 0 if ok, else -1.  
-  int deserialize(std::stringstream *p_ss, unsigned int *p_a=NULL) override;
+  // Get step count when Fruit is fully out of world (-1 if never).
+  int getOutStep() const;
+
+  // Fruit left world unsliced: all players lose points.
+  // Return 0 if ok, -1 if already sliced or missed.
+  int miss();
 };
 
 #endif // FRUIT_H
@@ -3,14 +3,15 @@
 //
 
 // Engine includes.
-#include "DisplayManager.h"
 #include "EventStep.h"
 #include "GameManager.h"
 #include "LogManager.h"
+#include "NetworkManager.h"
 #include "ResourceManager.h"
 #include "WorldManager.h"
 
 // Game includes.
+#include "Effects.h"
 #include "GameOver.h"
 #include "util.h"
 
@@ -33,7 +34,8 @@ GameOver::GameOver() {
   registerInterest(df::STEP_EVENT);
 
   // Shake screen (severity 20 pixels x&y, duration 10 frames).
-  DM.shake(20, 20, 10);
+  if (NM.isServer() == false)
+    FX.shake(20, 20, 10);
 
   LM.writeLog(1, "GameOver::GameOver(): created");
 }
@@ -62,7 +64,7 @@ int GameOver::step() {
   }
 
   if (m_time_to_live == 175)
-    play_sound("game-over");
+    play_sound(SOUND_GAME_OVER);
 
   // Handled.
   return 1;
@@ -0,0 +1,111 @@
+//
+// Governor.cpp
+//
+
+// Engine includes.
+#include "GameManager.h"
+#include "LogManager.h"
+
+// Game includes.
+#include "Governor.h"
+#include "Profiler.h"
+
+// Level names, for log.
+static const char *LEVEL_NAME[NUM_GOVERNOR_LEVELS] = {
+  "normal",
+  "sword-rate",
+  "merge",
+  "spawn-cap",
+  "skip-sync",
+};
+
+Governor::Governor() {
+  m_level = GOVERNOR_NORMAL;
+  m_tick_ms = 0.0f;
+  m_work_ms = 0.0f;
+  m_hold = 0;
+  m_good = 0;
+  m_started = false;
+}
+
+// Get the one and only instance of the Governor.
+Governor &Governor::getInstance() {
+  static Governor governor;
+  return governor;
+}
+
+// Call once per server step to watch tick time and adjust level.
+// Game loop sleeps off any time left in frame, so time between steps
+// is frame time (plus sleep overshoot) unless tick work overran it.
+void Governor::step() {
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  float work_ms = PROF.takeWork() / 1e6f;  // since last step
+  if (!m_started) {
+    m_started = true;
+    m_last = now;
+    m_tick_ms = (float) GM.getFrameTime();
+    return;
+  }
+  float tick_ms = std::chrono::duration<float, std::milli>(now - m_last).count();
+  m_last = now;
+  m_tick_ms += GOVERNOR_GAIN * (tick_ms - m_tick_ms);
+  m_work_ms += GOVERNOR_GAIN * (work_ms - m_work_ms);
+
+  float frame_ms = (float) GM.getFrameTime();
+  if (m_hold > 0)
+    m_hold -= 1;
+
+  // Overrun: shed next piece of work.
+  if (m_tick_ms > frame_ms * GOVERNOR_OVERRUN) {
+    m_good = 0;
+    if (m_hold == 0 && m_level < NUM_GOVERNOR_LEVELS - 1) {
+      setLevel((GovernorLevel) (m_level + 1));
+      m_hold = GOVERNOR_HOLD_TICKS;
+    }
+    return;
+  }
+
+  // Work under budget long enough: restore last piece of work.
+  if (m_work_ms < frame_ms * GOVERNOR_RECOVER) {
+    m_good += 1;
+    if (m_good >= GOVERNOR_RECOVER_TICKS && m_level > GOVERNOR_NORMAL) {
+      setLevel((GovernorLevel) (m_level - 1));
+      m_good = 0;
+    }
+  } else
+    m_good = 0;
+}
+
+// Change level, logging why.
+void Governor::setLevel(GovernorLevel new_level) {
+  LM.writeLog("Governor::setLevel(): step %d, tick %.1f ms, work %.1f ms (frame %d ms): %s -> %s",
+	      GM.getStepCount(), m_tick_ms, m_work_ms, GM.getFrameTime(),
+	      LEVEL_NAME[m_level], LEVEL_NAME[new_level]);
+  m_level = new_level;
+}
+
+// Get current level.
+GovernorLevel Governor::getLevel() const {
+  return m_level;
+}
+
+// Return true if level is at least given level.
+bool Governor::atLeast(GovernorLevel level) const {
+  return m_level >= level;
+}
+
+// Get smoothed time between steps (ms).
+float Governor::getTickTime() const {
+  return m_tick_ms;
+}
+
+// Get smoothed work per tick (ms).
+float Governor::getWorkTime() const {
+  return m_work_ms;
+}
+
+// Get level name.
+const char *Governor::levelName(GovernorLevel level) {
+  return LEVEL_NAME[level];
+}
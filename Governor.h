@@ -0,0 +1,85 @@
+//
+// Governor.h
+//
+// Server tick-overrun watchdog and quality governor.  Watches the
+// time between steps: when ticks run longer than the frame time,
+// the server falls behind and every client sees more latency, so the
+// governor raises its level, shedding work in order.  When the game's
+// work per tick (profiled phases) is well within the frame time for a
+// while, it steps back down.  Recovery uses work time, not time
+// between steps, since the latter includes sleep overshoot and never
+// drops much below the frame time.  Every level change is logged.
+//
+
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+// System includes.
+#include <chrono>
+
+// Governor levels.  Each level also keeps the savings of those below.
+enum GovernorLevel {
+  GOVERNOR_NORMAL,         // full quality
+  GOVERNOR_SWORD_RATE,     // relay Swords every other tick
+  GOVERNOR_MERGE,          // batch deletes, merge score updates
+  GOVERNOR_SPAWN_CAP,      // cap live Fruit
+  GOVERNOR_SKIP_SYNC,      // skip non-essential syncs (Kudos)
+  NUM_GOVERNOR_LEVELS,
+};
+
+// Governor settings.
+const float GOVERNOR_OVERRUN = 1.10f;    // tick/frame time to raise level
+const float GOVERNOR_RECOVER = 0.8f;     // work/frame time to lower level
+const float GOVERNOR_GAIN = 0.125f;      // tick time smoothing
+const int GOVERNOR_HOLD_TICKS = 30;      // min ticks between raises
+const int GOVERNOR_RECOVER_TICKS = 90;   // ticks under budget to lower
+const int GOVERNOR_SWORD_TICKS = 2;      // Sword relay period, when on
+const int GOVERNOR_MERGE_TICKS = 3;      // score sync period, when on
+const int GOVERNOR_MAX_FRUIT = 40;       // live Fruit cap, when on
+
+// Two-letter acronym for easier access to governor.
+#define GOV Governor::getInstance()
+
+class Governor {
+
+ private:
+  Governor();                            // Private since a singleton.
+  Governor(Governor const&);             // Don't allow copy.
+  void operator=(Governor const&);       // Don't allow assignment.
+
+  GovernorLevel m_level;                 // current level
+  float m_tick_ms;                       // smoothed time between steps
+  float m_work_ms;                       // smoothed work per tick
+  int m_hold;                            // ticks until may raise again
+  int m_good;                            // consecutive ticks under budget
+  bool m_started;                        // true once first step seen
+  std::chrono::steady_clock::time_point m_last; // time of last step
+
+  // Change level, logging why.
+  void setLevel(GovernorLevel new_level);
+
+ public:
+
+  // Get the one and only instance of the Governor.
+  static Governor &getInstance();
+
+  // Call once per server step to watch tick time and adjust level.
+  void step();
+
+  // Get current level.
+  GovernorLevel getLevel() const;
+
+  // Return true if level is at least given level.
+  bool atLeast(GovernorLevel level) const;
+
+  // Get smoothed time between steps (ms).
+  float getTickTime() const;
+
+  // Get smoothed work per tick (ms).
+  float getWorkTime() const;
+
+  // Get level name.
+  static const char *levelName(GovernorLevel level);
+};
+
+#endif // GOVERNOR_H
@@ -15,7 +15,9 @@
 // Game includes.
 #include "Fruit.h"
 #include "GameOver.h"
+#include "Governor.h"
 #include "Grocer.h"
+#include "Profiler.h"
 #include "Server.h"
 
 Grocer::Grocer(){
@@ -46,10 +48,27 @@ int Grocer::eventHandler(const df::Event *p_e) {
 // Handle step event.
 int Grocer::step(const df::EventStep *p_e) {
 
+  PROFILE_SCOPE(PROFILE_SPAWN);
+
   LM.writeLog(5, "Grocer::step(): wave %d, spawn %d", m_wave, m_spawn);
 
+  // Retire Fruit that have left the world (a miss).  Deletion is
+  // deferred, so registry is unchanged while looping.
+  int step_count = GM.getStepCount();
+  for (int i=0; i<Registry<Fruit>::getCount(); i++) {
+    Fruit *p_f = Registry<Fruit>::get(i);
+    if (p_f -> getOutStep() >= 0 && step_count >= p_f -> getOutStep())
+      p_f -> miss();
+  }
+
   // Fruit grocer.
+  // If governor is capping, no new Fruit while at cap.
   m_spawn -= 1;
+  if (m_spawn < 0 && GOV.atLeast(GOVERNOR_SPAWN_CAP) &&
+      Registry<Fruit>::getCount() >= GOVERNOR_MAX_FRUIT) {
+    LM.writeLog(5, "Grocer::step(): at cap of %d Fruit", GOVERNOR_MAX_FRUIT);
+    m_spawn = m_wave_spawn;
+  }
   if (m_spawn < 0) {
 
     int mod = m_wave+1 > NUM_FRUITS ? NUM_FRUITS : m_wave+1;
@@ -84,6 +103,7 @@ int Grocer::step(const df::EventStep *p_e) {
       // Send message to Client(s).
       char buff[] = "game over";
       SERVER -> sendMessage(df::MessageType::CUSTOM_MESSAGE, (int) strlen(buff), buff, -1);
+      SERVER -> countSent(df::MessageType::CUSTOM_MESSAGE, -1);
     }
   }
     
@@ -96,10 +116,8 @@ void Grocer::gameOver() {
   WM.markForDelete(this);
   
   // Destroy all remaining Fruit (no points).
-  df::ObjectList ol = WM.solidObjects();
-  for (int i=0; i<ol.getCount(); i++)
-    if (dynamic_cast <Fruit *> (ol[i]))
-      WM.markForDelete(ol[i]);
+  for (int i=0; i<Registry<Fruit>::getCount(); i++)
+    WM.markForDelete(Registry<Fruit>::get(i));
 }
 
 int Grocer::serialize(std::stringstream *p_ss, unsigned int attr) {
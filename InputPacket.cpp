@@ -0,0 +1,154 @@
+//
+// InputPacket.cpp
+//
+
+// System includes.
+#include <string.h>
+
+// Engine includes.
+#include "LogManager.h"
+
+// Game includes.
+#include "InputPacket.h"
+
+// Quantize delta to units, clamped to int16 range.
+static int16_t toDelta(float spaces) {
+  float d = spaces * INPUT_DELTA_SCALE;
+  d += d < 0 ? -0.5f : 0.5f;
+  if (d > 32767)
+    d = 32767;
+  if (d < -32768)
+    d = -32768;
+  return (int16_t) d;
+}
+
+// Decode packet into samples, oldest first; sequence number of first
+// (oldest) goes in p_first_seq.  Return number of samples, or -1 if
+// not an input packet or bad.
+int decodeInput(const void *p_data, int bytes, uint32_t *p_first_seq,
+		df::Vector *p_samples, int max) {
+
+  if (bytes < (int) sizeof(InputHeader))
+    return -1;
+  InputHeader h;
+  memcpy(&h, p_data, sizeof(h));
+  if (memcmp(h.tag, INPUT_TAG, sizeof(INPUT_TAG)) != 0)
+    return -1;
+  int count = h.count;
+  if (count < 1 || count > max || count > INPUT_PACKET_MAX ||
+      bytes < (int) (sizeof(InputHeader) + (count - 1) * sizeof(InputDelta)) ||
+      h.seq < (uint32_t) count)
+    return -1;
+
+  df::Vector newest(h.x, h.y);
+  const char *p_delta = (const char *) p_data + sizeof(InputHeader);
+  for (int i=0; i<count-1; i++) {
+    InputDelta d;
+    memcpy(&d, p_delta + i * sizeof(InputDelta), sizeof(d));
+    p_samples[i] = newest + df::Vector(d.dx / INPUT_DELTA_SCALE,
+				       d.dy / INPUT_DELTA_SCALE);
+  }
+  p_samples[count - 1] = newest;
+  *p_first_seq = h.seq - (count - 1);
+  return count;
+}
+
+InputEncoder::InputEncoder() {
+  m_seq = 0;
+  for (int i=0; i<INPUT_REDUNDANCY_MAX; i++)
+    m_new[i] = 0;
+  m_packets = 0;
+  m_redundancy = 1;
+  m_bytes = 0;
+  m_base_bytes = 0;
+  m_samples = 0;
+  m_repeated = 0;
+}
+
+// Set K from fraction of packets lost [0, 1], logging changes.
+void InputEncoder::adapt(float loss) {
+  int k = 1;
+  for (int i=1; i<INPUT_REDUNDANCY_MAX; i++)
+    if (loss >= INPUT_LOSS_STEP[i])
+      k = i + 1;
+  if (k == m_redundancy)
+    return;
+  LM.writeLog("InputEncoder::adapt(): loss %.1f%%: redundancy %d -> %d packets",
+	      loss * 100, m_redundancy, k);
+  m_redundancy = k;
+}
+
+// Get K.
+int InputEncoder::getRedundancy() const {
+  return m_redundancy;
+}
+
+// Add new samples (world spaces) and build packet holding them
+// plus those of last K packets.  Return packet size in bytes.
+int InputEncoder::encode(const df::Vector *p_samples, int count) {
+
+  if (count <= 0)
+    return 0;
+
+  // Too many to send: only newest are kept (and sent).
+  if (count > INPUT_PACKET_MAX) {
+    p_samples += count - INPUT_PACKET_MAX;
+    count = INPUT_PACKET_MAX;
+  }
+  for (int i=0; i<count; i++) {
+    m_seq += 1;
+    m_history[m_seq % INPUT_HISTORY] = p_samples[i];
+  }
+
+  // New samples, then those of last K packets, as far as fit.
+  int total = count;
+  for (int i=1; i<=m_redundancy && i<=m_packets; i++)
+    total += m_new[(m_packets - i) % INPUT_REDUNDANCY_MAX];
+  if (total > INPUT_PACKET_MAX)
+    total = INPUT_PACKET_MAX;
+  m_new[m_packets % INPUT_REDUNDANCY_MAX] = count;
+  m_packets += 1;
+
+  InputHeader h;
+  memcpy(h.tag, INPUT_TAG, sizeof(INPUT_TAG));
+  h.seq = m_seq;
+  df::Vector newest = m_history[m_seq % INPUT_HISTORY];
+  h.x = newest.getX();
+  h.y = newest.getY();
+  h.count = (uint16_t) total;
+  h.reserved = 0;
+  memcpy(m_buffer, &h, sizeof(h));
+
+  char *p_delta = m_buffer + sizeof(InputHeader);
+  for (int i=0; i<total-1; i++) {
+    df::Vector p = m_history[(m_seq - (total - 1) + i) % INPUT_HISTORY];
+    InputDelta d;
+    d.dx = toDelta(p.getX() - newest.getX());
+    d.dy = toDelta(p.getY() - newest.getY());
+    memcpy(p_delta + i * sizeof(InputDelta), &d, sizeof(d));
+  }
+
+  int bytes = (int) (sizeof(InputHeader) + (total - 1) * sizeof(InputDelta));
+  m_bytes += bytes;
+  m_base_bytes += sizeof(InputHeader) + (count - 1) * sizeof(InputDelta);
+  m_samples += count;
+  m_repeated += total - count;
+  return bytes;
+}
+
+// Get last packet built.
+const char *InputEncoder::getPacket() const {
+  return m_buffer;
+}
+
+// Log bytes sent and redundancy overhead since last report.
+void InputEncoder::report() {
+  if (m_base_bytes > 0)
+    LM.writeLog("InputEncoder::report(): %lld bytes (%d new, %d repeated samples), redundancy %d: overhead %.0f%%",
+		m_bytes, m_samples, m_repeated, m_redundancy,
+		100.0f * (m_bytes - m_base_bytes) / m_base_bytes);
+  m_bytes = 0;
+  m_base_bytes = 0;
+  m_samples = 0;
+  m_repeated = 0;
+}
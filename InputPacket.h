@@ -0,0 +1,95 @@
+//
+// InputPacket.h
+//
+// Mouse samples sent client to server, with redundancy so a lost
+// packet loses nothing: each packet repeats the samples of the last
+// K packets as well as the new ones.  Samples carry consecutive
+// sequence numbers, so the packet only holds the newest sequence
+// number and position; older samples are 16-bit deltas from it.  The
+// server applies only samples newer than the last one it applied.
+//
+// K adapts to loss measured from pings.  Bytes sent, and bytes that
+// new samples alone would have needed, are counted for an overhead
+// report.
+//
+// Packet (native byte order, a CUSTOM message):
+//   InputHeader, then InputDelta[count - 1], oldest first.
+//
+
+#ifndef INPUT_PACKET_H
+#define INPUT_PACKET_H
+
+// System includes.
+#include <stdint.h>
+
+// Engine includes.
+#include "Vector.h"
+
+// InputPacket settings.
+const char INPUT_TAG[4] = {'I', 'N', 'P', 'T'};
+const int INPUT_PACKET_MAX = 256;          // max samples per packet
+const int INPUT_HISTORY = 512;             // samples kept, power of 2
+const int INPUT_REDUNDANCY_MAX = 4;        // max K, packets repeated
+const float INPUT_DELTA_SCALE = 16.0f;     // delta units per space
+
+// Loss (fraction) at which K goes up to index + 1.
+const float INPUT_LOSS_STEP[INPUT_REDUNDANCY_MAX] = {0.0f, 0.02f, 0.05f, 0.15f};
+
+// Start of packet: newest sample.
+struct InputHeader {
+  char tag[4];                             // INPUT_TAG
+  uint32_t seq;                            // sequence number of newest
+  float x, y;                              // newest position, world spaces
+  uint16_t count;                          // samples, including newest
+  uint16_t reserved;
+};
+
+// Older sample, relative to newest.
+struct InputDelta {
+  int16_t dx, dy;                          // in 1/INPUT_DELTA_SCALE spaces
+};
+
+// Decode packet into samples, oldest first; sequence number of first
+// (oldest) goes in p_first_seq.  Return number of samples, or -1 if
+// not an input packet or bad.
+int decodeInput(const void *p_data, int bytes, uint32_t *p_first_seq,
+		df::Vector *p_samples, int max);
+
+// Client side: history of samples sent and packet builder.
+class InputEncoder {
+
+ private:
+  df::Vector m_history[INPUT_HISTORY];     // by seq % INPUT_HISTORY
+  uint32_t m_seq;                          // seq of newest sample, 0 if none
+  int m_new[INPUT_REDUNDANCY_MAX];         // new samples in recent packets
+  int m_packets;                           // packets built
+  int m_redundancy;                        // K
+  char m_buffer[sizeof(InputHeader) + (INPUT_PACKET_MAX - 1) * sizeof(InputDelta)];
+  long long m_bytes;                       // bytes built, since report
+  long long m_base_bytes;                  // bytes without redundancy
+  int m_samples;                           // new samples, since report
+  int m_repeated;                          // samples repeated, since report
+
+ public:
+
+  // Constructor.
+  InputEncoder();
+
+  // Set K from fraction of packets lost [0, 1], logging changes.
+  void adapt(float loss);
+
+  // Get K.
+  int getRedundancy() const;
+
+  // Add new samples (world spaces) and build packet holding them
+  // plus those of last K packets.  Return packet size in bytes.
+  int encode(const df::Vector *p_samples, int count);
+
+  // Get last packet built.
+  const char *getPacket() const;
+
+  // Log bytes sent and redundancy overhead since last report.
+  void report();
+};
+
+#endif // INPUT_PACKET_H
@@ -0,0 +1,133 @@
+//
+// InputSampler.cpp
+//
+
+// System includes.
+#include <chrono>
+
+// Game includes.
+#include "InputSampler.h"
+#include "Telemetry.h"
+
+// Pack pair of ints, for one atomic store.
+static uint64_t pack(int x, int y) {
+  return ((uint64_t) (uint32_t) x << 32) | (uint32_t) y;
+}
+
+// Unpack pair of ints.
+static sf::Vector2i unpack(uint64_t xy) {
+  return sf::Vector2i((int) (int32_t) (xy >> 32), (int) (int32_t) (uint32_t) xy);
+}
+
+InputSampler::InputSampler() {
+  m_head = 0;
+  m_tail = 0;
+  m_dropped = 0;
+  m_running = false;
+  m_p_window = NULL;
+  m_origin = 0;
+  m_size = 0;
+  m_period_us = 1000000 / INPUT_RATE_HZ;
+}
+
+// Get the one and only instance of the InputSampler.
+InputSampler &InputSampler::getInstance() {
+  static InputSampler input_sampler;
+  return input_sampler;
+}
+
+// Destructor, stops thread.
+InputSampler::~InputSampler() {
+  shutDown();
+}
+
+// Start sampling cursor in window, rate_hz times per second.
+// Return 0 if ok, else -1.
+int InputSampler::startUp(const sf::Window *p_window, int rate_hz) {
+  if (m_running)
+    return 0;
+  if (!p_window || rate_hz <= 0)
+    return -1;
+  m_p_window = p_window;
+  publish();
+  m_period_us = 1000000 / rate_hz;
+  m_running = true;
+  m_thread = std::thread(&InputSampler::sample, this);
+  return 0;
+}
+
+// Stop sampling thread.
+void InputSampler::shutDown() {
+  if (!m_running)
+    return;
+  m_running = false;
+  m_thread.join();
+}
+
+// Game thread: publish window origin (desktop pixels) and size for
+// sampler thread.  Origin is cursor on desktop less cursor in window,
+// both read now, so it is the drawable area's, not the frame's.
+void InputSampler::publish() {
+  if (!m_p_window)
+    return;
+  sf::Vector2i origin = sf::Mouse::getPosition() - sf::Mouse::getPosition(*m_p_window);
+  sf::Vector2u size = m_p_window -> getSize();
+  m_origin.store(pack(origin.x, origin.y), std::memory_order_relaxed);
+  m_size.store(pack((int) size.x, (int) size.y), std::memory_order_relaxed);
+}
+
+// Return true if sampling.
+bool InputSampler::isStarted() const {
+  return m_running;
+}
+
+// Sampling thread body.  Sleeps to next period boundary, so rate
+// does not drift with time spent sampling.
+void InputSampler::sample() {
+
+  std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+  sf::Vector2i last(-1, -1);
+
+  while (m_running) {
+
+    next += std::chrono::microseconds(m_period_us);
+    std::this_thread::sleep_until(next);
+
+    // Desktop cursor, made relative to window as last published.
+    sf::Vector2i pos = sf::Mouse::getPosition() -
+      unpack(m_origin.load(std::memory_order_relaxed));
+    sf::Vector2i size = unpack(m_size.load(std::memory_order_relaxed));
+    if (pos == last || pos.x < 0 || pos.y < 0 ||
+	pos.x >= size.x || pos.y >= size.y)
+      continue;
+    last = pos;
+
+    uint32_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) >= (uint32_t) INPUT_RING) {
+      m_dropped++;
+      continue;
+    }
+    InputSample &s = m_ring[head & (INPUT_RING - 1)];
+    s.time = Telemetry::now();
+    s.x = pos.x;
+    s.y = pos.y;
+    m_head.store(head + 1, std::memory_order_release);
+  }
+}
+
+// Move up to max queued samples, oldest first, into p_out.
+// Return number moved.
+int InputSampler::drain(InputSample *p_out, int max) {
+  uint32_t tail = m_tail.load(std::memory_order_relaxed);
+  uint32_t head = m_head.load(std::memory_order_acquire);
+  int n = 0;
+  while (tail != head && n < max)
+    p_out[n++] = m_ring[tail++ & (INPUT_RING - 1)];
+  m_tail.store(tail, std::memory_order_release);
+  return n;
+}
+
+// Get number of samples dropped (ring full).
+uint32_t InputSampler::getDropped() const {
+  return m_dropped;
+}
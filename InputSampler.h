@@ -0,0 +1,93 @@
+//
+// InputSampler.h
+//
+// Mouse sampled on its own thread at a fixed rate (default 240 Hz,
+// well above the 30 Hz game loop), so a fast swipe is a polyline
+// rather than one point per tick.  Samples are timestamped and go
+// through a lock-free single producer, single consumer ring; the game
+// thread drains all of them each tick.  Samples are only queued when
+// the cursor moves inside the window.
+//
+// SFML windows are not thread safe, so the sampler thread never
+// touches the window: it reads the desktop cursor position, and the
+// game thread publishes the window's origin and size each tick
+// (publish()).  On X11, the display SFML shares needs XInitThreads()
+// before the window opens (see fruit-client.cpp).
+//
+
+#ifndef INPUT_SAMPLER_H
+#define INPUT_SAMPLER_H
+
+// System includes.
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+
+// SFML includes.
+#include <SFML/Graphics.hpp>
+
+// InputSampler settings.
+const int INPUT_RATE_HZ = 240;          // default samples per second
+const int INPUT_RING = 1024;            // samples, power of 2
+
+// One cursor sample.
+struct InputSample {
+  int64_t time;                         // Telemetry::now(), in us
+  int x, y;                             // window pixels
+};
+
+// Two-letter acronym for easier access to input sampler.
+#define IS InputSampler::getInstance()
+
+class InputSampler {
+
+ private:
+  InputSampler();                       // Private since a singleton.
+  InputSampler(InputSampler const&);    // Don't allow copy.
+  void operator=(InputSampler const&);  // Don't allow assignment.
+
+  InputSample m_ring[INPUT_RING];
+  std::atomic<uint32_t> m_head;         // next to write (sampler)
+  std::atomic<uint32_t> m_tail;         // next to read (game)
+  std::atomic<uint32_t> m_dropped;      // samples dropped, ring full
+  std::atomic<bool> m_running;          // true while sampling
+  std::thread m_thread;
+  const sf::Window *m_p_window;         // window (game thread only)
+  std::atomic<uint64_t> m_origin;       // window origin on desktop (x, y)
+  std::atomic<uint64_t> m_size;         // window size, in pixels (x, y)
+  int m_period_us;                      // time between samples
+
+  // Sampling thread body.
+  void sample();
+
+ public:
+
+  // Get the one and only instance of the InputSampler.
+  static InputSampler &getInstance();
+
+  // Destructor, stops thread.
+  ~InputSampler();
+
+  // Start sampling cursor in window, rate_hz times per second.
+  // Return 0 if ok, else -1.
+  int startUp(const sf::Window *p_window, int rate_hz = INPUT_RATE_HZ);
+
+  // Stop sampling thread.
+  void shutDown();
+
+  // Game thread: publish window origin (desktop pixels) and size for
+  // sampler thread.  Call each tick, so window moves are followed.
+  void publish();
+
+  // Return true if sampling.
+  bool isStarted() const;
+
+  // Move up to max queued samples, oldest first, into p_out.
+  // Return number moved.
+  int drain(InputSample *p_out, int max);
+
+  // Get number of samples dropped (ring full).
+  uint32_t getDropped() const;
+};
+
+#endif // INPUT_SAMPLER_H
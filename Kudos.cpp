@@ -7,14 +7,14 @@
 
 // Engine includes.
 #include "EventStep.h"
-#include "EventView.h"
 #include "LogManager.h"
+#include "NetworkManager.h"
 #include "ResourceManager.h"
 #include "WorldManager.h"
 
 // Game includes.
+#include "Effects.h"
 #include "Kudos.h"
-#include "Points.h"
 #include "util.h"
 
 Kudos::Kudos(int sock_index) {
@@ -36,12 +36,11 @@ Kudos::Kudos(int sock_index) {
   setAnimation(a);
 
   // Play next Kudos sound.
-  static int s_sound = 1;  // next kudos sound
-  std::string sound = "kudos-" + std::to_string(s_sound);
-  play_sound(sound);
+  static int s_sound = 0;  // next kudos sound
+  play_sound(SOUND_KUDOS + s_sound);
   s_sound += 1;
-  if (s_sound > 10)
-    s_sound = 10;
+  if (s_sound > NUM_KUDOS - 1)
+    s_sound = NUM_KUDOS - 1;
 
   // Pick random location.
   df::Vector p(WM.getBoundary().getHorizontal()/8 +
@@ -50,12 +49,13 @@ Kudos::Kudos(int sock_index) {
 	       rand() % (3 * (int) WM.getBoundary().getVertical()/4));
   setPosition(p);
 
-  // Extra points.
-  df::EventView ev(POINTS_STRING, 50, true);
-  WM.onEvent(&ev);
-
-  m_countdown = 30; // Stays on the screen for 1 second.
+  m_countdown = KUDOS_TIME; // Stays on the screen for 1 second.
   registerInterest(df::STEP_EVENT);
+  Registry<Kudos>::insert(this, KUDOS_TYPE);
+}
+
+Kudos::~Kudos() {
+  Registry<Kudos>::remove(this);
 }
 
 // Handle event.
@@ -86,3 +86,26 @@ int Kudos::step(const df::EventStep *p_e) {
 int Kudos::getSocketIndex() const {
   return m_sock_index;
 }
+
+// Deserialize stream to attributes and apply.
+// Return 0 if ok, else -1.
+int Kudos::deserialize(std::stringstream *p_ss, unsigned int *p_a) {
+
+  // Deserialize parent (position and sprite frame).
+  int ret = Object::deserialize(p_ss, p_a);
+  if (ret != 0) {
+    LM.writeLog("Kudos::deserialize(): Error calling Object::deserialize().");
+    return ret;
+  }
+
+  // Client only shows kudos, so no need to keep an Object around.
+  // (Server never sends DELETE for Kudos; each side deletes its own.)
+  if (NM.isServer() == false) {
+    FX.popup(getAnimation().getSprite(), getAnimation().getIndex(),
+	     getPosition(), KUDOS_TIME);
+    setVisible(false);
+    WM.markForDelete(this);
+  }
+
+  return 0;
+}
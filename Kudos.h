@@ -13,9 +13,13 @@
 #include "EventStep.h"
 #include "Object.h"
 
+// Game includes.
+#include "Registry.h"
+
 const std::string KUDOS_STRING = "Kudos";
+const int KUDOS_TIME = 30; // in ticks (1 second)
 
-class Kudos : public df::Object {
+class Kudos : public df::Object, public Registered {
 
  private:
   int m_countdown;	   // message lifetime, in ticks
@@ -29,11 +33,21 @@ public:
   // Constructor.
   Kudos(int sock_index=-1);
 
+  // Destructor.
+  ~Kudos();
+
   // Handle events.
   int eventHandler(const df::Event *p_e) override;
 
   // Get socket index.
   int getSocketIndex() const;
+
+  // Deserialize stream to attributes and apply.
+  // Client hands the kudos to Effects as a popup, then deletes itself.
+  // p_ss - incoming stream to deserialize.
+  // p_a - outgoing bitmask of attributes modified (NULL means no outgoing).
+  // Return 0 if ok, else -1.  
+  int deserialize(std::stringstream *p_ss, unsigned int *p_a=NULL) override;
 };
 
 #endif // KUDOS_H
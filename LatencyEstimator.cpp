@@ -0,0 +1,120 @@
+//
+// LatencyEstimator.cpp
+//
+
+// System includes.
+#include <math.h>
+
+// Game includes.
+#include "LatencyEstimator.h"
+
+LatencyEstimator::LatencyEstimator() {
+  m_estimate = LATENCY_INITIAL_MS;
+  m_variance = LATENCY_INITIAL_SD * LATENCY_INITIAL_SD;
+  m_noise = LATENCY_INITIAL_NOISE;
+  m_last_us = 0;
+  m_updates = 0;
+  m_offset_count = 0;
+  m_offset_next = 0;
+}
+
+// Grow variance for time passed, then fold in measurement z with
+// variance r.  Far outliers are down-weighted, not dropped.
+void LatencyEstimator::update(float z, float r, int64_t now_us) {
+
+  if (m_updates > 0 && now_us > m_last_us)
+    m_variance += LATENCY_DRIFT * (float) (now_us - m_last_us) / 1e6f;
+  m_last_us = now_us;
+
+  float innovation = z - m_estimate;
+  float gate = LATENCY_GATE * LATENCY_GATE * (m_variance + r);
+  if (innovation * innovation > gate)
+    r *= innovation * innovation / gate;
+
+  float gain = m_variance / (m_variance + r);
+  m_estimate += gain * innovation;
+  m_variance *= 1.0f - gain;
+  if (m_estimate < 0)
+    m_estimate = 0;
+  m_updates += 1;
+}
+
+// Add ping echo: sent and received (client clock), with server
+// time when echoed (server clock, < 0 if unknown).
+void LatencyEstimator::addPing(int64_t sent_us, int64_t server_us,
+			       int64_t received_us) {
+
+  float rtt = (float) (received_us - sent_us) / 1000;
+  if (rtt < 0)
+    return;
+
+  // Clock offset for this ping (server time at midpoint).
+  if (server_us >= 0) {
+    m_offset_rtt[m_offset_next] = rtt;
+    m_offset_ms[m_offset_next] = (server_us - (sent_us + received_us) / 2.0) / 1000;
+    m_offset_next = (m_offset_next + 1) % LATENCY_OFFSET_WINDOW;
+    if (m_offset_count < LATENCY_OFFSET_WINDOW)
+      m_offset_count += 1;
+  }
+
+  // Measurement noise tracks spread of pings about estimate (gated,
+  // so one spike doesn't swamp it).
+  float z = rtt / 2;
+  float innovation = z - m_estimate;
+  float spread = innovation * innovation - m_variance;
+  float limit = LATENCY_GATE * LATENCY_GATE * (m_variance + m_noise);
+  if (spread > limit)
+    spread = limit;
+  if (m_updates > 0)
+    m_noise += LATENCY_NOISE_GAIN * (spread - m_noise);
+  if (m_noise < LATENCY_MIN_NOISE)
+    m_noise = LATENCY_MIN_NOISE;
+
+  update(z, m_noise, received_us);
+}
+
+// Add message sent at server_us (server clock) and received at
+// received_us (client clock).  Ignored until clock offset known.
+void LatencyEstimator::addServerTime(int64_t server_us, int64_t received_us) {
+  if (!hasOffset())
+    return;
+  float z = (float) ((received_us - server_us) / 1000.0 + getOffset());
+  if (z < 0)
+    z = 0;
+  update(z, m_noise * LATENCY_SYNC_NOISE, received_us);
+}
+
+// Get one-way latency estimate, ms.
+float LatencyEstimator::getOneWay() const {
+  return m_estimate;
+}
+
+// Get round trip estimate, ms.
+float LatencyEstimator::getRoundTrip() const {
+  return 2 * m_estimate;
+}
+
+// Get standard deviation of one-way estimate, ms.
+float LatencyEstimator::getStdDev() const {
+  return sqrtf(m_variance);
+}
+
+// Return true once clock offset known.
+bool LatencyEstimator::hasOffset() const {
+  return m_offset_count > 0;
+}
+
+// Get server clock minus client clock, ms (0 if not known).
+// From ping with lowest round trip in window.
+double LatencyEstimator::getOffset() const {
+  int best = -1;
+  for (int i=0; i<m_offset_count; i++)
+    if (best < 0 || m_offset_rtt[i] < m_offset_rtt[best])
+      best = i;
+  return best < 0 ? 0 : m_offset_ms[best];
+}
+
+// Get number of measurements used.
+int LatencyEstimator::getUpdates() const {
+  return m_updates;
+}
@@ -0,0 +1,85 @@
+//
+// LatencyEstimator.h
+//
+// Client's estimate of one-way latency to server: a scalar Kalman
+// filter fed by every ping echo (half the round trip) and by every
+// server-timestamped message (arrival time minus server send time,
+// less clock offset).  Clock offset is estimated NTP style, from the
+// server time in ping echoes, taking the lowest round trip of recent
+// pings as most accurate.  Gives a smoothed estimate and its standard
+// deviation as confidence.
+//
+// As with NTP, one-way means half the round trip: a path slower in one
+// direction (e.g., server's added delay) is seen as symmetric.
+//
+// No engine dependencies, so fruit-lateval can replay traces offline.
+//
+
+#ifndef LATENCY_ESTIMATOR_H
+#define LATENCY_ESTIMATOR_H
+
+// System includes.
+#include <stdint.h>
+
+// LatencyEstimator settings.
+const float LATENCY_INITIAL_MS = 50.0f;    // prior one-way latency
+const float LATENCY_INITIAL_SD = 100.0f;   // prior standard deviation, ms
+const float LATENCY_DRIFT = 10.0f;         // process noise, ms^2 per second
+const float LATENCY_INITIAL_NOISE = 25.0f; // prior ping variance, ms^2
+const float LATENCY_MIN_NOISE = 1.0f;      // min measurement variance, ms^2
+const float LATENCY_NOISE_GAIN = 0.1f;     // measurement variance smoothing
+const float LATENCY_SYNC_NOISE = 2.0f;     // server-time variance, x ping's
+const float LATENCY_GATE = 3.0f;           // sigmas before sample down-weighted
+const int LATENCY_OFFSET_WINDOW = 8;       // pings searched for clock offset
+
+class LatencyEstimator {
+
+ private:
+  float m_estimate;                        // one-way latency, ms
+  float m_variance;                        // of estimate, ms^2
+  float m_noise;                           // ping measurement variance, ms^2
+  int64_t m_last_us;                       // time of last update
+  int m_updates;                           // measurements used
+
+  float m_offset_rtt[LATENCY_OFFSET_WINDOW];  // recent ping round trips, ms
+  double m_offset_ms[LATENCY_OFFSET_WINDOW];  // and their clock offsets
+  int m_offset_count;
+  int m_offset_next;
+
+  // Grow variance for time passed, then fold in measurement z with
+  // variance r.  Far outliers are down-weighted, not dropped.
+  void update(float z, float r, int64_t now_us);
+
+ public:
+
+  // Constructor.
+  LatencyEstimator();
+
+  // Add ping echo: sent and received (client clock), with server
+  // time when echoed (server clock, < 0 if unknown).
+  void addPing(int64_t sent_us, int64_t server_us, int64_t received_us);
+
+  // Add message sent at server_us (server clock) and received at
+  // received_us (client clock).  Ignored until clock offset known.
+  void addServerTime(int64_t server_us, int64_t received_us);
+
+  // Get one-way latency estimate, ms.
+  float getOneWay() const;
+
+  // Get round trip estimate, ms.
+  float getRoundTrip() const;
+
+  // Get standard deviation of one-way estimate, ms.
+  float getStdDev() const;
+
+  // Return true once clock offset known.
+  bool hasOffset() const;
+
+  // Get server clock minus client clock, ms (0 if not known).
+  double getOffset() const;
+
+  // Get number of measurements used.
+  int getUpdates() const;
+};
+
+#endif // LATENCY_ESTIMATOR_H
@@ -0,0 +1,251 @@
+//
+// NetTrace.cpp
+//
+
+// System includes.
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Engine includes.
+#include "GameManager.h"
+#include "LogManager.h"
+#include "NetworkManager.h"
+
+// Game includes.
+#include "NetTrace.h"
+
+NetTrace::NetTrace() {
+  m_start_step = -1;
+}
+
+// Get the one and only instance of the NetTrace.
+NetTrace &NetTrace::getInstance() {
+  static NetTrace net_trace;
+  return net_trace;
+}
+
+// Return true if whole string is a number.
+static bool isNumber(const char *p_s) {
+  char *p_end;
+  strtod(p_s, &p_end);
+  return p_end != p_s && *p_end == '\0';
+}
+
+// Add lost records for seqs skipped between last record and seq at time.
+static void addGap(std::vector<TraceRecord> &records, int last_seq, int seq,
+		   double time) {
+  if (records.empty() || seq <= last_seq + 1)
+    return;
+  double from = records.back().time;
+  for (int s=last_seq+1; s<seq; s++) {
+    TraceRecord r;
+    r.time = from + (time - from) * (s - last_seq) / (seq - last_seq);
+    r.delay = 0;
+    r.lost = true;
+    records.push_back(r);
+  }
+}
+
+// Load trace file, for next socket.  Return 0 if ok, else -1.
+int NetTrace::load(std::string filename) {
+
+  FILE *p_f = fopen(filename.c_str(), "r");
+  if (!p_f) {
+    LM.writeLog("NetTrace::load(): Error! Unable to open '%s'.", filename.c_str());
+    return -1;
+  }
+
+  Trace trace;
+  trace.name = filename;
+  const char *format = "plain";
+  double frame_ms = GM.getFrameTime();
+  int last_seq = -1;
+  int connection = -1;
+  double first_epoch = -1;
+  char line[1024];
+  while (fgets(line, sizeof(line), p_f)) {
+    TraceRecord r;
+    r.lost = false;
+
+    // Telemetry CSV: step,connection,seq,rtt_ms,...
+    if (strncmp(line, "step,connection,seq,rtt_ms", 26) == 0) {
+      format = "telemetry";
+      continue;
+    }
+    if (strcmp(format, "telemetry") == 0) {
+      int step, conn, seq;
+      if (sscanf(line, "%d,%d,%d,%f", &step, &conn, &seq, &r.delay) != 4)
+	continue;
+      if (connection < 0)
+	connection = conn;
+      if (conn != connection)
+	continue;  // First connection only.
+      r.time = step * frame_ms;
+      addGap(trace.records, last_seq, seq, r.time);
+      trace.records.push_back(r);
+      last_seq = seq;
+      continue;
+    }
+
+    // ping output: [epoch] ... icmp_seq=N ... time=T ms
+    const char *p_seq = strstr(line, "icmp_seq");
+    if (p_seq) {
+      format = "ping";
+      int seq = atoi(p_seq + strlen("icmp_seq") + 1);
+      double epoch;
+      if (line[0] == '[' && sscanf(line + 1, "%lf", &epoch) == 1) {
+	if (first_epoch < 0)
+	  first_epoch = epoch;
+	r.time = (epoch - first_epoch) * 1000;
+      } else
+	r.time = seq * 1000.0;  // ping default interval
+      const char *p_time = strstr(line, "time=");
+      if (p_time)
+	r.delay = (float) atof(p_time + 5);
+      else {
+	r.delay = 0;
+	r.lost = true;  // e.g., "Request timeout for icmp_seq N"
+      }
+      addGap(trace.records, last_seq, seq, r.time);
+      trace.records.push_back(r);
+      last_seq = seq;
+      continue;
+    }
+
+    // Plain: "delay_ms" or "time_ms delay_ms", negative or "lost" is loss.
+    if (strcmp(format, "plain") != 0 || line[0] == '#')
+      continue;
+    char a[64], b[64];
+    int n = sscanf(line, "%63s %63s", a, b);
+    if (n < 1)
+      continue;
+    const char *p_delay = n == 2 ? b : a;
+    if (!isNumber(p_delay) && strcmp(p_delay, "lost") != 0)
+      continue;  // Not a trace line (e.g., ping header).
+    if (n == 2 && !isNumber(a))
+      continue;
+    r.time = n == 2 ? atof(a) : trace.records.size() * TRACE_PLAIN_INTERVAL;
+    r.lost = strcmp(p_delay, "lost") == 0 || atof(p_delay) < 0;
+    r.delay = r.lost ? 0 : (float) atof(p_delay);
+    trace.records.push_back(r);
+  }
+  fclose(p_f);
+
+  // Times from 0, in order; trace lasts one mean interval past last.
+  std::stable_sort(trace.records.begin(), trace.records.end(),
+		   [](const TraceRecord &x, const TraceRecord &y) { return x.time < y.time; });
+  int delivered = 0;
+  double delay_sum = 0;
+  for (const TraceRecord &r : trace.records)
+    if (!r.lost) {
+      delivered += 1;
+      delay_sum += r.delay;
+    }
+  if (delivered == 0) {
+    LM.writeLog("NetTrace::load(): Error! No delivered packets in '%s'.",
+		filename.c_str());
+    return -1;
+  }
+  double t0 = trace.records.front().time;
+  for (TraceRecord &r : trace.records)
+    r.time -= t0;
+  size_t count = trace.records.size();
+  double last = trace.records.back().time;
+  if (count > 1 && last <= 0) {
+    LM.writeLog("NetTrace::load(): Error! All packets in '%s' at same time.",
+		filename.c_str());
+    return -1;
+  }
+  trace.duration = count > 1 ? last + last / (count - 1) : frame_ms;
+
+  LM.writeLog("NetTrace::load(): %s (%s) for socket %d: %d packets over %.1f s, mean delay %.1f ms, loss %.1f%%",
+	      filename.c_str(), format, (int) m_traces.size(), (int) count,
+	      trace.duration / 1000, delay_sum / delivered,
+	      100.0 * (count - delivered) / count);
+  m_traces.push_back(trace);
+  return 0;
+}
+
+// Return true if any trace loaded.
+bool NetTrace::isLoaded() const {
+  return !m_traces.empty();
+}
+
+// Get delay (ms) for socket at game time (ms), from trace:
+// interpolated between delivered samples, plus retransmission
+// timeout if a loss falls in [time, time + window).
+float NetTrace::getDelay(int sock_index, double time, double window) const {
+
+  if (m_traces.empty() || sock_index < 0)
+    return 0;
+  const Trace &trace = m_traces[sock_index % m_traces.size()];
+  const std::vector<TraceRecord> &records = trace.records;
+  int count = (int) records.size();
+  double t = fmod(time, trace.duration);
+
+  // First record after t.
+  int next = (int) (std::upper_bound(records.begin(), records.end(), t,
+    [](double v, const TraceRecord &r) { return v < r.time; }) - records.begin());
+
+  // Delivered records either side (wrapping), interpolated.
+  int before = -1, after = -1;
+  for (int i=1; i<=count && before < 0; i++) {
+    int j = ((next - i) % count + count) % count;
+    if (!records[j].lost)
+      before = j;
+  }
+  for (int i=0; i<count && after < 0; i++) {
+    int j = (next + i) % count;
+    if (!records[j].lost)
+      after = j;
+  }
+  float delay = records[before].delay;
+  double t_before = records[before].time;
+  double t_after = records[after].time;
+  if (t_before > t)
+    t_before -= trace.duration;
+  if (t_after <= t)
+    t_after += trace.duration;
+  if (t_after > t_before)
+    delay += (float) ((t - t_before) / (t_after - t_before)) *
+      (records[after].delay - records[before].delay);
+
+  // Loss in this window: retransmitted.
+  int first = (int) (std::lower_bound(records.begin(), records.end(), t,
+    [](const TraceRecord &r, double v) { return r.time < v; }) - records.begin());
+  for (int i=first; i<count && records[i].time < t + window; i++)
+    if (records[i].lost)
+      return delay + TRACE_RTO_MS;
+
+  return delay;
+}
+
+// Start replay (at game start), so trace time is game time.
+// Until then, trace start is used.
+void NetTrace::start() {
+  m_start_step = GM.getStepCount();
+  if (isLoaded())
+    LM.writeLog("NetTrace::start(): Replay from step %d.", m_start_step);
+}
+
+// Once per tick: set delay for every connected socket.
+// Engine delays in whole ticks, so delay is rounded to ticks.
+void NetTrace::step() {
+
+  if (m_traces.empty())
+    return;
+
+  double frame_ms = GM.getFrameTime();
+  int step = m_start_step < 0 ? 0 : GM.getStepCount() - m_start_step;
+  for (int i=0; i<NM.getNumConnections(); i++) {
+    float delay = getDelay(i, step * frame_ms, frame_ms);
+    int ticks = (int) (delay / frame_ms + 0.5f);
+    if (NM.setDelay(ticks, i) != 0)
+      LM.writeLog("NetTrace::step(): Error setting delay for socket %d.", i);
+    LM.writeLog(5, "NetTrace::step(): step %d, socket %d: %.1f ms (%d ticks)",
+		step, i, delay, ticks);
+  }
+}
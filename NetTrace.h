@@ -0,0 +1,86 @@
+//
+// NetTrace.h
+//
+// Server network emulator replaying recorded latency and loss, in
+// place of the fixed DELAY.  Each tick, every socket's send delay is
+// set from its trace at that game time (trace wraps), so the same
+// trace gives the same network on every run, whatever the game sends.
+//
+// Trace formats, told apart by content:
+//  - Telemetry CSV written by this game (telemetry*.csv): round trip
+//    per ping; seq gaps are losses.
+//  - ping output ("icmp_seq=N ... time=T ms", optional [epoch] from
+//    ping -D); seq gaps and timeouts are losses.
+//  - Plain: one packet per line, "delay_ms" or "time_ms delay_ms";
+//    negative delay (or "lost") is a loss.
+// Delay is applied server to client only, so a recorded round trip
+// is replayed as is (clients on same host or LAN).
+//
+// The engine's connections are TCP, so loss can't drop a message:
+// as TCP would, a loss adds a retransmission timeout, and later
+// messages queue behind it.
+//
+
+#ifndef NET_TRACE_H
+#define NET_TRACE_H
+
+// System includes.
+#include <string>
+#include <vector>
+
+// NetTrace settings.
+const float TRACE_RTO_MS = 200.0f;      // retransmission timeout, as TCP min
+const float TRACE_PLAIN_INTERVAL = 33.0f; // ms between lines, plain w/o time
+
+// One trace sample.
+struct TraceRecord {
+  double time;                          // ms from start of trace
+  float delay;                          // ms (unused if lost)
+  bool lost;
+};
+
+// One loaded trace.
+struct Trace {
+  std::string name;
+  std::vector<TraceRecord> records;     // sorted by time
+  double duration;                      // ms, before wrapping
+};
+
+// Two-letter acronym for easier access to net trace.
+#define NT NetTrace::getInstance()
+
+class NetTrace {
+
+ private:
+  NetTrace();                           // Private since a singleton.
+  NetTrace(NetTrace const&);            // Don't allow copy.
+  void operator=(NetTrace const&);      // Don't allow assignment.
+
+  std::vector<Trace> m_traces;          // socket i uses i % count
+  int m_start_step;                     // step replay started, -1 if not yet
+
+ public:
+
+  // Get the one and only instance of the NetTrace.
+  static NetTrace &getInstance();
+
+  // Load trace file, for next socket.  Return 0 if ok, else -1.
+  int load(std::string filename);
+
+  // Return true if any trace loaded.
+  bool isLoaded() const;
+
+  // Get delay (ms) for socket at game time (ms), from trace:
+  // interpolated between delivered samples, plus retransmission
+  // timeout if a loss falls in [time, time + window).
+  float getDelay(int sock_index, double time, double window) const;
+
+  // Start replay (at game start), so trace time is game time.
+  // Until then, trace start is used.
+  void start();
+
+  // Once per tick: set delay for every connected socket.
+  void step();
+};
+
+#endif // NET_TRACE_H
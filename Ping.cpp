@@ -24,9 +24,14 @@ Ping::Ping() {
 }
 
 // Set ping value (latency) and update color based on latency.
-void Ping::setPingValue(int value) {
+// Spread shown only when estimate is still unsure.
+void Ping::setPingValue(int value, int spread) {
 
 	setValue(value);
+	if (spread > PING_SHOW_SPREAD)
+		setViewString("Ping (+/-" + std::to_string(spread) + "):");
+	else
+		setViewString("Ping: ");
 
 	// Update the color based on latency.
 	if (value < 100) {
@@ -38,7 +43,7 @@ void Ping::setPingValue(int value) {
 	else {
 		setColor(df::RED);     // Red >300ms
 	}
-	LM.writeLog("Ping::setPingValue(): Updated PING to %d ms.", value);
+	LM.writeLog("Ping::setPingValue(): Updated PING to %d ms (+/- %d).", value, spread);
 }
 
 int Ping::eventHandler(const df::Event* p_e) {
@@ -46,7 +51,7 @@ int Ping::eventHandler(const df::Event* p_e) {
 		const PingEvent* ping_e = dynamic_cast<const PingEvent*>(p_e);
 		if (ping_e) {
 			// Set the new ping value.
-			setPingValue(ping_e->getLatency());
+			setPingValue(ping_e->getLatency(), ping_e->getSpread());
 			return 1;
 		}
 		// if PING event is not handled, call parent handler
@@ -9,6 +9,8 @@
 #include "ViewObject.h"
 #include "GameManager.h"
 
+const int PING_SHOW_SPREAD = 20;   // ms, above which spread is shown
+
 class Ping : public df::ViewObject {
 private:
 
@@ -16,8 +18,8 @@ public:
 	// Constructor.
 	Ping();
 
-	// Set set ping value
-	void setPingValue(int value);
+	// Set set ping value (and its standard deviation)
+	void setPingValue(int value, int spread = 0);
 
 	// Handle PING events
 	int eventHandler(const df::Event* p_e)  override;
@@ -3,11 +3,16 @@
 //
 #include "PingEvent.h"
 
-PingEvent::PingEvent(int latency) {
+PingEvent::PingEvent(int latency, int spread) {
     setType(PING_EVENT);
     latency_ms = latency;
+    spread_ms = spread;
 }
 
 int PingEvent::getLatency() const {
     return latency_ms;
+}
+
+int PingEvent::getSpread() const {
+    return spread_ms;
 }
\ No newline at end of file
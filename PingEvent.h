@@ -13,13 +13,17 @@ const std::string PING_EVENT = "ping";
 class PingEvent : public df::Event {
 private:
 	int latency_ms;
+	int spread_ms;
 
 public:
-	// Constructor.
-	PingEvent(int latency);
+	// Constructor (spread is standard deviation of latency, if known).
+	PingEvent(int latency, int spread = 0);
 
 	// Get the ping latency.
 	int getLatency() const;
+
+	// Get standard deviation of latency.
+	int getSpread() const;
 };
 
 #endif // PINGEVENT_H
\ No newline at end of file
@@ -16,6 +16,11 @@ Points::Points() {
   setColor(df::WHITE);
   setType(POINTS_STRING);
   setValue(0);
+  Registry<Points>::insert(this, POINTS_TYPE);
+}
+
+Points::~Points() {
+  Registry<Points>::remove(this);
 }
 
 void Points::setValue(int value) {
@@ -10,14 +10,20 @@
 #include "Event.h"		
 #include "ViewObject.h"
 
+// Game includes.
+#include "Registry.h"
+
 #define POINTS_STRING "Points"
 
-class Points : public df::ViewObject {
+class Points : public df::ViewObject, public Registered {
 
  public:
   // Constructor.
   Points();
 
+  // Destructor.
+  ~Points();
+
   // Set value.
   void setValue(int value) override;
 };
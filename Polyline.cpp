@@ -0,0 +1,116 @@
+//
+// Polyline.cpp
+//
+
+// Engine includes.
+#include "Line.h"
+#include "utility.h"
+
+// Game includes.
+#include "Polyline.h"
+
+Polyline::Polyline() {
+  m_count = 0;
+  m_chunk_count = 0;
+}
+
+// Clear, then start path at point.
+void Polyline::start(df::Vector p) {
+  m_point[0] = p;
+  m_count = 1;
+  m_chunk_count = 0;
+}
+
+// Add point to end of path.  Repeats of last point are skipped.
+// If full, last point is moved instead.
+void Polyline::add(df::Vector p) {
+
+  if (m_count > 0 && m_point[m_count - 1] == p)
+    return;
+
+  if (m_count == POLYLINE_MAX)
+    m_point[m_count - 1] = p;
+  else
+    m_point[m_count++] = p;
+
+  // Chunk holding last segment has changed.
+  int chunk = (m_count - 2) / POLYLINE_CHUNK;
+  if (chunk >= 0 && m_chunk_count > chunk)
+    m_chunk_count = chunk;
+}
+
+// Get number of points.
+int Polyline::getCount() const {
+  return m_count;
+}
+
+// Get last point (origin if empty).
+df::Vector Polyline::getLast() const {
+  if (m_count == 0)
+    return df::Vector();
+  return m_point[m_count - 1];
+}
+
+// Get length along path, in spaces.
+float Polyline::getLength() const {
+  float length = 0;
+  for (int i=1; i<m_count; i++)
+    length += df::distance(m_point[i - 1], m_point[i]);
+  return length;
+}
+
+// Compute bounds for chunks not yet done.
+void Polyline::updateChunks() {
+  int segments = m_count - 1;
+  int chunks = (segments + POLYLINE_CHUNK - 1) / POLYLINE_CHUNK;
+  for (int c=m_chunk_count; c<chunks; c++) {
+    int first = c * POLYLINE_CHUNK;
+    int last = first + POLYLINE_CHUNK;  // last point of chunk
+    if (last > segments)
+      last = segments;
+    PolylineChunk &b = m_chunk[c];
+    b.min_x = b.max_x = m_point[first].getX();
+    b.min_y = b.max_y = m_point[first].getY();
+    for (int i=first+1; i<=last; i++) {
+      float x = m_point[i].getX(), y = m_point[i].getY();
+      if (x < b.min_x) b.min_x = x;
+      if (x > b.max_x) b.max_x = x;
+      if (y < b.min_y) b.min_y = y;
+      if (y > b.max_y) b.max_y = y;
+    }
+  }
+  m_chunk_count = chunks;
+}
+
+// Return true if any segment of path intersects box.
+bool Polyline::intersects(const df::Box &box) {
+
+  if (m_count < 2)
+    return false;
+  updateChunks();
+
+  float left = box.getCorner().getX();
+  float top = box.getCorner().getY();
+  float right = left + box.getHorizontal();
+  float bottom = top + box.getVertical();
+
+  int segments = m_count - 1;
+  for (int c=0; c<m_chunk_count; c++) {
+
+    // Early out: box misses chunk bounds.
+    const PolylineChunk &b = m_chunk[c];
+    if (b.max_x < left || b.min_x > right ||
+	b.max_y < top || b.min_y > bottom)
+      continue;
+
+    int first = c * POLYLINE_CHUNK;
+    int last = first + POLYLINE_CHUNK;
+    if (last > segments)
+      last = segments;
+    for (int i=first; i<last; i++)
+      if (df::lineIntersectsBox(df::Line(m_point[i], m_point[i + 1]), box))
+	return true;
+  }
+
+  return false;
+}
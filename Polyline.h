@@ -0,0 +1,64 @@
+//
+// Polyline.h
+//
+// Path a Sword moved along in one tick, from every mouse sample the
+// server got (not just the latest), for slicing.  Segments are grouped
+// in chunks with a bounding box each, so a Fruit box away from a chunk
+// skips all of that chunk's segment tests.
+//
+
+#ifndef POLYLINE_H
+#define POLYLINE_H
+
+// Engine includes.
+#include "Box.h"
+#include "Vector.h"
+
+// Polyline settings.
+const int POLYLINE_MAX = 1024;   // max points per tick (1 kHz for 1 second)
+const int POLYLINE_CHUNK = 8;    // segments per bounding box
+const int POLYLINE_CHUNKS = (POLYLINE_MAX + POLYLINE_CHUNK - 2) / POLYLINE_CHUNK;
+
+// Bounds of one chunk of segments.
+struct PolylineChunk {
+  float min_x, min_y;
+  float max_x, max_y;
+};
+
+class Polyline {
+
+ private:
+  df::Vector m_point[POLYLINE_MAX];        // points, in world spaces
+  int m_count;                             // number of points
+  PolylineChunk m_chunk[POLYLINE_CHUNKS];  // bounds, by chunk
+  int m_chunk_count;                       // chunks with bounds computed
+
+  // Compute bounds for chunks not yet done.
+  void updateChunks();
+
+ public:
+
+  // Constructor.
+  Polyline();
+
+  // Clear, then start path at point.
+  void start(df::Vector p);
+
+  // Add point to end of path.  Repeats of last point are skipped.
+  // If full, last point is moved instead.
+  void add(df::Vector p);
+
+  // Get number of points.
+  int getCount() const;
+
+  // Get last point (origin if empty).
+  df::Vector getLast() const;
+
+  // Get length along path, in spaces.
+  float getLength() const;
+
+  // Return true if any segment of path intersects box.
+  bool intersects(const df::Box &box);
+};
+
+#endif // POLYLINE_H
@@ -0,0 +1,178 @@
+//
+// Profiler.cpp
+//
+
+// Engine includes.
+#include "EventStep.h"
+#include "GameManager.h"
+#include "LogManager.h"
+#include "NetworkManager.h"
+
+// Game includes.
+#include "Profiler.h"
+
+// Phase names, for stats file.
+static const char *PHASE_NAME[NUM_PROFILE_PHASES] = {
+  "input",
+  "network",
+  "spawn",
+  "slice",
+  "sync",
+  "trail",
+  "draw",
+};
+
+// Get phase name.
+const char *profilePhaseName(ProfilePhase phase) {
+  return PHASE_NAME[phase];
+}
+
+// Return bucket for value: linear below 2^(SUB_BITS+1), then
+// 2^SUB_BITS buckets per power of 2.
+static int bucketOf(uint64_t v) {
+  int msb = 0;
+  for (uint64_t t = v; t > 1; t >>= 1)
+    msb += 1;
+  int shift = msb - PROFILE_SUB_BITS;
+  if (shift < 0)
+    shift = 0;
+  int index = (shift << PROFILE_SUB_BITS) + (int) (v >> shift);
+  return index < PROFILE_BUCKETS ? index : PROFILE_BUCKETS - 1;
+}
+
+// Return largest value in bucket.
+static uint64_t bucketTop(int index) {
+  int sub_count = 1 << PROFILE_SUB_BITS;
+  int shift = index < 2 * sub_count ? 0 : index / sub_count - 1;
+  uint64_t sub = (uint64_t) (index - (shift << PROFILE_SUB_BITS));
+  return ((sub + 1) << shift) - 1;
+}
+
+ProfileHistogram::ProfileHistogram() {
+  clear();
+}
+
+// Add duration.
+void ProfileHistogram::add(uint64_t ns) {
+  m_bucket[bucketOf(ns)] += 1;
+  m_count += 1;
+  if (ns > m_max)
+    m_max = ns;
+}
+
+// Get value at percentile [0, 100] (upper edge of its bucket).
+uint64_t ProfileHistogram::getPercentile(double percentile) const {
+  if (m_count == 0)
+    return 0;
+  uint64_t rank = (uint64_t) (percentile / 100.0 * m_count + 0.5);
+  if (rank < 1)
+    rank = 1;
+  uint64_t seen = 0;
+  for (int i=0; i<PROFILE_BUCKETS; i++) {
+    seen += m_bucket[i];
+    if (seen >= rank)
+      return bucketTop(i) < m_max ? bucketTop(i) : m_max;
+  }
+  return m_max;
+}
+
+// Get largest value added.
+uint64_t ProfileHistogram::getMax() const {
+  return m_max;
+}
+
+// Get number of values added.
+uint32_t ProfileHistogram::getCount() const {
+  return m_count;
+}
+
+// Remove all values.
+void ProfileHistogram::clear() {
+  for (int i=0; i<PROFILE_BUCKETS; i++)
+    m_bucket[i] = 0;
+  m_count = 0;
+  m_max = 0;
+}
+
+Profiler *Profiler::s_p_instance = NULL;
+
+Profiler::Profiler() {
+  setType(PROFILER_STRING);
+  setSolidness(df::SPECTRAL);
+  setVisible(false);
+  registerInterest(df::STEP_EVENT);
+  for (int i=0; i<NUM_PROFILE_PHASES; i++)
+    m_summary[i].count = 0;
+  m_ticks = 0;
+  m_work_ns = 0;
+}
+
+Profiler::~Profiler() {
+  s_p_instance = NULL;
+}
+
+// Get the one and only Profiler (created on first use).
+Profiler &Profiler::getInstance() {
+  if (!s_p_instance)
+    s_p_instance = new Profiler();
+  return *s_p_instance;
+}
+
+// Handle event.
+// Return 0 if ignored, else 1.
+int Profiler::eventHandler(const df::Event *p_e) {
+
+  // Step event.
+  if (p_e->getType() == df::STEP_EVENT) {
+    m_ticks += 1;
+    if (m_ticks >= PROFILE_DUMP_TICKS) {
+      dump();
+      m_ticks = 0;
+    }
+    return 1;
+  }
+
+  // If get here, have ignored this event.
+  return 0;
+}
+
+// Add duration (in ns) to phase.
+void Profiler::record(ProfilePhase phase, uint64_t ns) {
+  m_histogram[phase].add(ns);
+  m_work_ns += ns;
+}
+
+// Get total duration (in ns) recorded, all phases, since last call,
+// then reset.  Nested scopes count twice, so errs high.
+uint64_t Profiler::takeWork() {
+  uint64_t ns = m_work_ns;
+  m_work_ns = 0;
+  return ns;
+}
+
+// Write p50/p99/max of each phase (in microseconds) to stats file,
+// then clear.  Phases with no samples this second are skipped.
+void Profiler::dump() {
+
+  std::string filename = NM.isServer() ? PROFILE_SERVER_LOG : PROFILE_CLIENT_LOG;
+
+  for (int i=0; i<NUM_PROFILE_PHASES; i++) {
+    ProfileHistogram &h = m_histogram[i];
+    ProfileSummary &s = m_summary[i];
+    s.count = h.getCount();
+    if (s.count == 0)
+      continue;
+    s.p50 = h.getPercentile(50) / 1000.0f;
+    s.p99 = h.getPercentile(99) / 1000.0f;
+    s.max = h.getMax() / 1000.0f;
+    LM.writeMyLog(filename,
+		  "step %d: %-8s count %5u  p50 %9.1f  p99 %9.1f  max %9.1f us",
+		  GM.getStepCount(), PHASE_NAME[i], s.count, s.p50, s.p99, s.max);
+    h.clear();
+  }
+}
+
+// Get phase stats from last dump (count 0 if no samples).
+const ProfileSummary &Profiler::getSummary(ProfilePhase phase) const {
+  return m_summary[phase];
+}
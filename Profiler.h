@@ -0,0 +1,147 @@
+//
+// Profiler.h
+//
+// Per-phase tick profiler.  PROFILE_SCOPE(phase) times the rest of
+// the enclosing block into a log-linear (HDR-style) histogram for that
+// phase.  Once a second, p50/p99/max of each phase are written to a
+// stats file and the histograms cleared.  Compiling with NO_PROFILE
+// removes all markers.
+//
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// System includes.
+#include <chrono>
+#include <stdint.h>
+
+// Engine includes.
+#include "Object.h"
+
+const std::string PROFILER_STRING = "Profiler";
+
+// Profiled phases.
+enum ProfilePhase {
+  PROFILE_INPUT,                // local mouse and keyboard
+  PROFILE_NETWORK,              // network messages received
+  PROFILE_SPAWN,                // Grocer spawning and retiring Fruit
+  PROFILE_SLICE,                // Sword slicing and points
+  PROFILE_SYNC,                 // Server serializing and sending
+  PROFILE_TRAIL,                // creating trail samples
+  PROFILE_DRAW,                 // drawing Swords and effects
+  NUM_PROFILE_PHASES,
+};
+
+// Profiler settings.
+const int PROFILE_DUMP_TICKS = 30;    // ticks between dumps (1 second)
+const int PROFILE_SUB_BITS = 4;       // 16 sub-buckets per power of 2
+const int PROFILE_BUCKETS = 640;      // covers up to 2^40 ns
+const std::string PROFILE_SERVER_LOG = "profile-server.log";
+const std::string PROFILE_CLIENT_LOG = "profile-client.log";
+
+// Histogram of durations, in ns.  Bucket width doubles every 16
+// buckets, so values are within ~6% of their true value.
+class ProfileHistogram {
+
+ private:
+  uint32_t m_bucket[PROFILE_BUCKETS];
+  uint32_t m_count;
+  uint64_t m_max;
+
+ public:
+
+  // Constructor.
+  ProfileHistogram();
+
+  // Add duration.
+  void add(uint64_t ns);
+
+  // Get value at percentile [0, 100] (upper edge of its bucket).
+  uint64_t getPercentile(double percentile) const;
+
+  // Get largest value added.
+  uint64_t getMax() const;
+
+  // Get number of values added.
+  uint32_t getCount() const;
+
+  // Remove all values.
+  void clear();
+};
+
+// Phase stats from last dump, in microseconds.
+struct ProfileSummary {
+  uint32_t count;
+  float p50, p99, max;
+};
+
+// Get phase name.
+const char *profilePhaseName(ProfilePhase phase);
+
+// Two-letter acronym for easier access to profiler.
+#define PROF Profiler::getInstance()
+
+class Profiler : public df::Object {
+
+ private:
+  static Profiler *s_p_instance;        // the one and only Profiler
+  ProfileHistogram m_histogram[NUM_PROFILE_PHASES];
+  ProfileSummary m_summary[NUM_PROFILE_PHASES]; // from last dump
+  int m_ticks;                          // ticks since last dump
+  uint64_t m_work_ns;                   // recorded since last takeWork()
+
+  Profiler();                           // Private, use getInstance().
+  Profiler(Profiler const&);            // Don't allow copy.
+  void operator=(Profiler const&);      // Don't allow assignment.
+
+  // Write p50/p99/max of each phase to stats file, then clear.
+  void dump();
+
+ public:
+
+  // Get the one and only Profiler (created on first use).
+  static Profiler &getInstance();
+
+  // Destructor.
+  ~Profiler();
+
+  // Handle events.
+  int eventHandler(const df::Event *p_e) override;
+
+  // Add duration (in ns) to phase.
+  void record(ProfilePhase phase, uint64_t ns);
+
+  // Get total duration (in ns) recorded, all phases, since last call,
+  // then reset.  Nested scopes count twice, so errs high.
+  uint64_t takeWork();
+
+  // Get phase stats from last dump (count 0 if no samples).
+  const ProfileSummary &getSummary(ProfilePhase phase) const;
+};
+
+// Times its own lifetime into phase.
+class ProfileScope {
+
+ private:
+  ProfilePhase m_phase;
+  std::chrono::steady_clock::time_point m_start;
+
+ public:
+  ProfileScope(ProfilePhase phase) {
+    m_phase = phase;
+    m_start = std::chrono::steady_clock::now();
+  }
+  ~ProfileScope() {
+    PROF.record(m_phase, (uint64_t)
+		std::chrono::duration_cast<std::chrono::nanoseconds>
+		(std::chrono::steady_clock::now() - m_start).count());
+  }
+};
+
+#ifdef NO_PROFILE
+#define PROFILE_SCOPE(phase)
+#else
+#define PROFILE_SCOPE(phase) ProfileScope profile_scope(phase)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,35 @@
+//
+// Registry.cpp
+//
+
+// System includes.
+#include <unordered_map>
+
+// Game includes.
+#include "Kudos.h"
+#include "Points.h"
+#include "Registry.h"
+#include "Sword.h"
+#include "Timer.h"
+#include "util.h"
+
+// Return game type tag for Object type string (as sent over network).
+// UNDEFINED_GAME_TYPE if not a registered type.
+GameType stringToGameType(std::string type) {
+
+  static std::unordered_map<std::string, GameType> s_string_type;
+  if (s_string_type.empty()) {
+    for (int i=0; i<NUM_FRUITS; i++)
+      s_string_type[FRUIT[i]] = FRUIT_TYPE;
+    s_string_type[SWORD_STRING] = SWORD_TYPE;
+    s_string_type[POINTS_STRING] = POINTS_TYPE;
+    s_string_type[TIMER_STRING] = TIMER_TYPE;
+    s_string_type[KUDOS_STRING] = KUDOS_TYPE;
+  }
+
+  std::unordered_map<std::string, GameType>::const_iterator it =
+    s_string_type.find(type);
+  if (it == s_string_type.end())
+    return UNDEFINED_GAME_TYPE;
+  return it -> second;
+}
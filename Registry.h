@@ -0,0 +1,108 @@
+//
+// Registry.h
+//
+// Per-type registries of live game Objects (Fruit, Swords, Points,
+// Timers, Kudos), kept up to date by constructors and destructors,
+// so hot loops walk only the Objects they care about instead of
+// scanning the whole world.  Registered Objects also carry a compact
+// game type tag (a member, next to their slot), for dispatch without
+// RTTI or string compares.
+//
+
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+// System includes.
+#include <string>
+#include <vector>
+
+// Engine includes.
+#include "Object.h"
+
+// Game Object type tags.
+enum GameType {
+  UNDEFINED_GAME_TYPE = -1,
+  FRUIT_TYPE,
+  SWORD_TYPE,
+  POINTS_TYPE,
+  TIMER_TYPE,
+  KUDOS_TYPE,
+};
+
+// Return game type tag for Object type string (as sent over network).
+// UNDEFINED_GAME_TYPE if not a registered type.
+GameType stringToGameType(std::string type);
+
+// Mixin for registered Objects: slot in their registry and type tag.
+class Registered {
+
+ private:
+  int m_registry_index;		// slot in registry, -1 if none
+  GameType m_game_type;		// UNDEFINED_GAME_TYPE if not registered
+
+ public:
+  Registered() { m_registry_index = -1; m_game_type = UNDEFINED_GAME_TYPE; }
+
+  // Set slot in registry.
+  void setRegistryIndex(int new_index) { m_registry_index = new_index; }
+
+  // Get slot in registry.
+  int getRegistryIndex() const { return m_registry_index; }
+
+  // Set game type tag.
+  void setGameType(GameType new_type) { m_game_type = new_type; }
+
+  // Get game type tag.
+  GameType getGameType() const { return m_game_type; }
+};
+
+// Registry of all live Objects of class T (T derives from Registered).
+// Removal swaps in the last entry, so order is not preserved.
+template <class T>
+class Registry {
+
+ private:
+  static std::vector<T *> s_list;
+
+ public:
+
+  // Add Object to registry, tagging it with type.
+  static void insert(T *p_t, GameType type) {
+    p_t -> setRegistryIndex((int) s_list.size());
+    s_list.push_back(p_t);
+    p_t -> setGameType(type);
+  }
+
+  // Remove Object from registry.
+  static void remove(T *p_t) {
+    int index = p_t -> getRegistryIndex();
+    if (index < 0 || index >= (int) s_list.size() || s_list[index] != p_t)
+      return;
+    T *p_last = s_list.back();
+    s_list[index] = p_last;
+    p_last -> setRegistryIndex(index);
+    s_list.pop_back();
+    p_t -> setRegistryIndex(-1);
+    p_t -> setGameType(UNDEFINED_GAME_TYPE);
+  }
+
+  // Return number of registered Objects.
+  static int getCount() { return (int) s_list.size(); }
+
+  // Return registered Object at index [0, getCount()-1].
+  static T *get(int index) { return s_list[index]; }
+
+  // Return true if Object is registered here.  Linear, so for small
+  // registries (e.g., Swords) given only a df::Object.
+  static bool contains(const df::Object *p_o) {
+    for (size_t i=0; i<s_list.size(); i++)
+      if ((const df::Object *) s_list[i] == p_o)
+	return true;
+    return false;
+  }
+};
+
+template <class T>
+std::vector<T *> Registry<T>::s_list;
+
+#endif // REGISTRY_H
@@ -0,0 +1,89 @@
+//
+// Scoreboard.cpp
+//
+
+// Engine includes.
+#include "LogManager.h"
+
+// Game includes.
+#include "Scoreboard.h"
+
+Scoreboard::Scoreboard() {
+  for (int i=0; i<MAX_SCORE_PLAYERS; i++) {
+    m_p_points[i] = NULL;
+    m_delta[i] = 0;
+  }
+  m_dirty = 0;
+  m_all_delta = 0;
+  m_num_players = 0;
+}
+
+// Get the one and only instance of the Scoreboard.
+Scoreboard &Scoreboard::getInstance() {
+  static Scoreboard scoreboard;
+  return scoreboard;
+}
+
+// Set Points view showing player score (NULL to clear).
+void Scoreboard::setPoints(int player, Points *p_points) {
+
+  if (player < 0 || player >= MAX_SCORE_PLAYERS) {
+    LM.writeLog("Scoreboard::setPoints(): Error! Player %d out of range.",
+		player);
+    return;
+  }
+
+  m_p_points[player] = p_points;
+  m_delta[player] = 0;
+  m_dirty &= ~(1ULL << player);
+
+  // Players are numbered from 0, so count is one past highest view.
+  m_num_players = 0;
+  for (int i=0; i<MAX_SCORE_PLAYERS; i++)
+    if (m_p_points[i])
+      m_num_players = i + 1;
+}
+
+// Add delta to player score (applied at flush).
+// Ignored if player has no Points view.
+void Scoreboard::add(int player, int delta) {
+  if (player < 0 || player >= MAX_SCORE_PLAYERS || delta == 0 ||
+      !m_p_points[player])
+    return;
+  m_delta[player] += delta;
+  m_dirty |= 1ULL << player;
+}
+
+// Add delta to every player score (applied at flush).
+void Scoreboard::addAll(int delta) {
+  m_all_delta += delta;
+}
+
+// Apply pending changes to Points views, once per tick.
+// Return number of players whose score changed.
+int Scoreboard::flush() {
+
+  if (m_dirty == 0 && m_all_delta == 0)
+    return 0;
+
+  int changed = 0;
+  for (int i=0; i<m_num_players; i++) {
+
+    int delta = m_all_delta;
+    if (m_dirty & (1ULL << i))
+      delta += m_delta[i];
+    m_delta[i] = 0;
+
+    if (delta == 0 || !m_p_points[i])
+      continue;
+
+    // Points clamps at 0 and marks value modified, for sync.
+    m_p_points[i] -> setValue(m_p_points[i] -> getValue() + delta);
+    changed += 1;
+  }
+
+  m_dirty = 0;
+  m_all_delta = 0;
+
+  return changed;
+}
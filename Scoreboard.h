@@ -0,0 +1,54 @@
+//
+// Scoreboard.h
+//
+// Server-side scores, indexed by player (socket index).
+// Score changes during a tick are accumulated with dirty tracking
+// and applied to the Points views once, by flush(), so the hot path
+// builds no strings and broadcasts no view events.
+//
+
+#ifndef SCOREBOARD_H
+#define SCOREBOARD_H
+
+// Game includes.
+#include "Points.h"
+
+const int MAX_SCORE_PLAYERS = 64; // One dirty bit per player.
+
+// Two-letter acronym for easier access to scoreboard.
+#define SB Scoreboard::getInstance()
+
+class Scoreboard {
+
+ private:
+  Scoreboard();                       // Private since a singleton.
+  Scoreboard(Scoreboard const&);      // Don't allow copy.
+  void operator=(Scoreboard const&);  // Don't allow assignment.
+
+  Points *m_p_points[MAX_SCORE_PLAYERS]; // view for each player
+  int m_delta[MAX_SCORE_PLAYERS];        // pending change for each player
+  unsigned long long m_dirty;            // bit set if player has change
+  int m_all_delta;                       // pending change for all players
+  int m_num_players;                     // players with views
+
+ public:
+
+  // Get the one and only instance of the Scoreboard.
+  static Scoreboard &getInstance();
+
+  // Set Points view showing player score (NULL to clear).
+  void setPoints(int player, Points *p_points);
+
+  // Add delta to player score (applied at flush).
+  // Ignored if player has no Points view.
+  void add(int player, int delta);
+
+  // Add delta to every player score (applied at flush).
+  void addAll(int delta);
+
+  // Apply pending changes to Points views, once per tick.
+  // Return number of players whose score changed.
+  int flush();
+};
+
+#endif // SCOREBOARD_H
@@ -3,6 +3,8 @@
 //
 
 // System includes.
+#include <algorithm> // for std::min()
+#include <stdio.h>  // for sscanf()
 #include <string.h> // for memcpy()
 
 // Engine includes.
@@ -14,12 +16,21 @@
 #include "WorldManager.h"
 
 // Game includes.
+#include "BinLog.h"
 #include "Fruit.h"
 #include "GameOver.h"
+#include "Governor.h"
 #include "Grocer.h"
+#include "InputPacket.h"
 #include "Kudos.h"
+#include "NetTrace.h"
+#include "Profiler.h"
+#include "Registry.h"
+#include "Scoreboard.h"
 #include "Server.h"
+#include "StatsServer.h"
 #include "Sword.h"
+#include "Telemetry.h"
 #include "Timer.h"
 #include "util.h"
 #include <EventNetworkCustom.h>
@@ -30,7 +41,10 @@ Server::Server() {
     for (int i = 0; i < MAX_PLAYERS; i++) {
         p_sword[i] = NULL;
         p_points[i] = NULL;
+        input_seq[i] = 0;
     }
+    ping_count = 0;
+    ping_seq = 0;
 
     // Set as network server.
     setType(SERVER_STRING);
@@ -51,15 +65,28 @@ Server::Server() {
 int Server::eventHandler(const df::Event* p_e) {
 
     // Step event.
-    if (p_e->getType() == df::STEP_EVENT && NM.isConnected())
-        return handleStep((const df::EventStep*)p_e);
+    if (p_e->getType() == df::STEP_EVENT) {
+        STATS.step();
+        NT.step();
+        if (NM.isConnected()) {
+            GOV.step();
+            ping();
+            return handleStep((const df::EventStep*)p_e);
+        }
+    }
 
     // Custom network event PING
     if (p_e->getType() == df::NETWORK_CUSTOM_EVENT)
         return handleEventNetworkCustom((df::EventNetworkCustom*)p_e);
 
-    // Call parent event handler.
-    return NetworkNode::eventHandler(p_e);
+    // Call parent event handler, counting any message received.
+    int ret = NetworkNode::eventHandler(p_e);
+    if (p_e->getType() == df::NETWORK_EVENT) {
+        const df::EventNetwork* p_en = (const df::EventNetwork*)p_e;
+        if (p_en->getLabel() == df::NetworkEventLabel::DATA && p_en->getBytes() > 0)
+            STATS.countReceived((df::MessageType)((int*)m_p_buff)[1], p_en->getBytes());
+    }
+    return ret;
 
 } // End of eventHandler().
 
@@ -67,9 +94,14 @@ int Server::handleAccept(const df::EventNetwork* p_en) {
     LM.writeLog("Server::handleAccept(): Server connected to socket: %d", p_en->getSocketIndex());
 
     int sock_index = p_en->getSocketIndex();
+    if (sock_index >= 0 && sock_index < MAX_PLAYERS)
+        input_seq[sock_index] = 0;
 
-   // Set delay this client.
-    if (NM.setDelay(DELAY, sock_index) != 0) {
+   // Set delay this client (from trace each step, if replaying one).
+    if (NT.isLoaded()) {
+        LM.writeLog("Server::handleAccept(): Trace delay for socket %d", sock_index);
+    }
+    else if (NM.setDelay(DELAY, sock_index) != 0) {
         LM.writeLog("Server::handleAccept(): ERROR setting delay for socket %d", sock_index);
     }
     else {
@@ -80,6 +112,7 @@ int Server::handleAccept(const df::EventNetwork* p_en) {
     char buff[50];
     sprintf_s(buff, "index %d", sock_index);
     sendMessage(df::MessageType::CUSTOM_MESSAGE, (int)strlen(buff), buff, sock_index);
+    countSent(df::MessageType::CUSTOM_MESSAGE, sock_index);
 
     // If enough players connected or Grocer started, nothing else to do.
     if (NM.getNumConnections() < MAX_PLAYERS || WM.objectsOfType("Grocer").getCount() == 1)
@@ -116,6 +149,7 @@ int Server::handleAccept(const df::EventNetwork* p_en) {
         s += ":";
         p_p->setViewString(s);
         p_points[i] = p_p;
+        SB.setPoints(i, p_p);
         LM.writeLog(1, "Server::handleAccept(): Points %d created.", i);
     }
 
@@ -125,82 +159,202 @@ int Server::handleAccept(const df::EventNetwork* p_en) {
     // Timer for time progress.
     new Timer();
 
+    // Replay network traces in game time.
+    NT.start();
+
     LM.writeLog(1, "Server::handleAccept(): Game has begun.");
 
     return 1;
 }
 
 // If any Objects need to be synchronized, send to Clients.
+// (See project description writeup for what & when to sync.)
+// Walks only the registries of synced types.
 int Server::handleStep(const df::EventStep* p_es) {
 
-    // Iterate through all Objects.
-    df::ObjectList ol = WM.getAllObjects();
-    for (int i = 0; i < ol.getCount(); i++) {
-        Object* p_o = ol[i];
-
-        // (See project description writeup for what & when to sync.)
-        int sock_index = -2; // -2 means don't sync
-        if (p_o->getType() == SWORD_STRING) {
-            if (p_o->isModified(df::ObjectAttribute::POSITION)) {
-                Sword* p_s = dynamic_cast <Sword*> (p_o);
-                if (p_s->getSocketIndex() == 1) {
-                    sock_index = 0;
-                }
-                else {
-                    sock_index = 1;
-                }
-            }
-        }
-        if ((dynamic_cast <Fruit*> (p_o)))
-            if (p_o->isModified(df::ObjectAttribute::ID))
-                sock_index = -1; // sync with all
-        if ((dynamic_cast <Timer*> (p_o)))
-            if (p_o->isModified(df::ObjectAttribute::ID))
-                sock_index = -1; // sync with all
-        if ((dynamic_cast <Points*> (p_o))) {
-            unsigned int mask = (unsigned int)df::ObjectAttribute::ID |
-                (unsigned int)df::ViewObjectAttribute::VALUE;
-            if (p_o->isModified((df::ObjectAttribute)mask))
-                sock_index = -1; // sync with all
+    PROFILE_SCOPE(PROFILE_SYNC);
+
+    int step_count = GM.getStepCount();
+
+    // Apply this tick's score changes, so Points sync once.
+    // If governor is merging, only every few ticks.
+    if (!GOV.atLeast(GOVERNOR_MERGE) || step_count % GOVERNOR_MERGE_TICKS == 0)
+        SB.flush();
+
+    // Swords, when moved, to the other player, as spline control
+    // points (only when curve strays too far from samples).
+    // If governor is limiting rate, only every other tick (samples
+    // wait in fitter, so whole path goes next time).
+    bool relay = !GOV.atLeast(GOVERNOR_SWORD_RATE) ||
+        step_count % GOVERNOR_SWORD_TICKS == 0;
+    for (int i = 0; relay && i < Registry<Sword>::getCount(); i++) {
+        Sword* p_s = Registry<Sword>::get(i);
+        std::vector<df::Vector> points;
+        if (p_s->fitPath(points) > 0)
+            sendPath(p_s, points, p_s->getSocketIndex() == 1 ? 0 : 1);
+    }
+
+    // Fruit, when new, to all.
+    for (int i = 0; i < Registry<Fruit>::getCount(); i++) {
+        Fruit* p_f = Registry<Fruit>::get(i);
+        if (p_f->isModified(df::ObjectAttribute::ID))
+            sync(p_f, p_f->getGameType(), -1);
+    }
+
+    // Timer, when new, to all.
+    for (int i = 0; i < Registry<Timer>::getCount(); i++) {
+        Timer* p_t = Registry<Timer>::get(i);
+        if (p_t->isModified(df::ObjectAttribute::ID))
+            sync(p_t, p_t->getGameType(), -1);
+    }
+
+    // Points, when new or value changed, to all.
+    unsigned int mask = (unsigned int)df::ObjectAttribute::ID |
+        (unsigned int)df::ViewObjectAttribute::VALUE;
+    for (int i = 0; i < Registry<Points>::getCount(); i++) {
+        Points* p_p = Registry<Points>::get(i);
+        if (p_p->isModified((df::ObjectAttribute)mask))
+            sync(p_p, p_p->getGameType(), -1);
+    }
+
+    // Kudos, when new, to only the client that earned it.
+    // Not essential, so skipped if governor says so.
+    for (int i = 0; !GOV.atLeast(GOVERNOR_SKIP_SYNC) && i < Registry<Kudos>::getCount(); i++) {
+        Kudos* p_k = Registry<Kudos>::get(i);
+        if (p_k->isModified(df::ObjectAttribute::ID))
+            sync(p_k, p_k->getGameType(), p_k->getSocketIndex());
+    }
+
+    // DELETEs batched this tick.
+    sendDeletes();
+
+    return 1;
+}
+
+// Send Sword path control points to client(s) (-1 is all).
+void Server::sendPath(Sword* p_s, const std::vector<df::Vector>& points, int sock_index) {
+    std::vector<char> buffer;
+    for (size_t i = 0; i < points.size(); i += SPLINE_MAX_POINTS) {
+        int count = (int)std::min(points.size() - i, (size_t)SPLINE_MAX_POINTS);
+        int bytes = encodeSpline(p_s->getId(), Telemetry::now(), &points[i], count, buffer);
+        BINLOG("Server::sendPath(): Sword %d, %d points, sock_index %d",
+            p_s->getId(), count, sock_index);
+        if (sendMessage(df::MessageType::CUSTOM_MESSAGE, bytes, buffer.data(), sock_index) == -1) {
+            LM.writeLog("Server::sendPath(): ERROR after sendMessage().");
+            return;
         }
-        if ((dynamic_cast <Kudos*> (p_o)))
-            if (p_o->isModified(df::ObjectAttribute::ID)) {
-                Kudos* p_k = dynamic_cast <Kudos*> (p_o);
-                sock_index = p_k->getSocketIndex(); // sync with only that client
-            }
-
-        // If needed, send to client(s).
-        if (sock_index != -2) {
-            LM.writeLog(1, "Server::handleStep(): SYNC %s (id %d), sock_index %d",
-                p_o->getType().c_str(),
-                p_o->getId(),
-                sock_index);
-            if (sendMessage(df::MessageType::SYNC_OBJECT, p_o, 0, sock_index) == -1) {
-                LM.writeLog("Server::handleStep(): ERROR after sendMessage().");
-                exit(-1);
-            }
+        countSent(df::MessageType::CUSTOM_MESSAGE, sock_index);
+    }
+}
+
+// Send Object, with game type tag for log, to client(s) (-1 is all).
+void Server::sync(df::Object* p_o, GameType type, int sock_index) {
+    BINLOG("Server::sync(): SYNC type %d (id %d), sock_index %d",
+        type, p_o->getId(), sock_index);
+    if (sendMessage(df::MessageType::SYNC_OBJECT, p_o, 0, sock_index) == -1) {
+        LM.writeLog("Server::sync(): ERROR after sendMessage().");
+        exit(-1);
+    }
+    countSent(df::MessageType::SYNC_OBJECT, sock_index);
+}
+
+// Send DELETE for Object to all clients.
+// Batched until end of tick if governor is merging.
+void Server::deleteObject(df::Object* p_o) {
+    if (GOV.atLeast(GOVERNOR_MERGE)) {
+        delete_ids.push_back(p_o->getId());
+        return;
+    }
+    BINLOG("Server::deleteObject(): DELETE id %d", p_o->getId());
+    if (sendMessage(df::MessageType::DELETE_OBJECT, p_o) == -1) {
+        LM.writeLog("Server::deleteObject(): ERROR after sendMessage().");
+        return;
+    }
+    countSent(df::MessageType::DELETE_OBJECT, -1);
+}
+
+// Send batched DELETEs, as few custom messages: "Delete <id> <id> ...".
+void Server::sendDeletes() {
+
+    size_t i = 0;
+    while (i < delete_ids.size()) {
+        std::string msg = "Delete";
+        while (i < delete_ids.size() && msg.size() < 200) {
+            msg += " " + std::to_string(delete_ids[i]);
+            i++;
         }
+        BINLOG("Server::sendDeletes(): DELETE batch of %d bytes", (int)msg.size());
+        if (sendMessage(df::MessageType::CUSTOM_MESSAGE, (int)msg.size() + 1, msg.c_str()) == -1)
+            LM.writeLog("Server::sendDeletes(): ERROR after sendMessage().");
+        else
+            countSent(df::MessageType::CUSTOM_MESSAGE, -1);
+    }
+    delete_ids.clear();
+}
+
+// Count last message sent (to client(s), -1 is all), for stats.
+// Message size is first int in buffer.
+void Server::countSent(df::MessageType type, int sock_index) {
+    int recipients = sock_index == -1 ? NM.getNumConnections() : 1;
+    STATS.countSent(type, ((int*)m_p_buff)[0] * recipients);
+}
 
-    } // End of iterate through all Objects.
+// Send PING to all clients, for per-client round trip times.
+// Clients echo it back: "Sping <seq> <time in microseconds>".
+void Server::ping() {
 
-    return 1;
+    ping_count++;
+    if (ping_count < 15)
+        return;
+    ping_count = 0;
+
+    char buff[50];
+    sprintf_s(buff, "Sping %d %lld", ping_seq, (long long)Telemetry::now());
+    if (sendMessage(df::MessageType::CUSTOM_MESSAGE, (int)strlen(buff) + 1, buff) == 1) {
+        countSent(df::MessageType::CUSTOM_MESSAGE, -1);
+        for (int i = 0; i < NM.getNumConnections(); i++)
+            TM.sent(i, ping_seq);
+    }
+    ping_seq++;
 }
 
 // Handle custom PING messages from clients.
 int Server::handleEventNetworkCustom(const df::EventNetworkCustom* p_en) {
 
+    PROFILE_SCOPE(PROFILE_NETWORK);
+
     // getMessage of client
     const void* message = p_en->getMessage();
 
     // Cast the const void* to const char*
     const char* charMessage = static_cast<const char*>(message);
 
-    char buff[50];
-    strcpy_s(buff, charMessage);
+    // Mouse samples.
+    if (handleInput(p_en))
+        return 1;
+
+    // Echo of server PING: record round trip time.
+    int seq;
+    long long sent_us;
+    if (sscanf(charMessage, "Sping %d %lld", &seq, &sent_us) == 2) {
+        TM.received(p_en->getSocketIndex(), seq, (int64_t)sent_us);
+        return 1;
+    }
+
+    // Echo client PING, adding server time for client's clock offset:
+    // "Ping <seq> <client time> <server time>" (microseconds).
+    char buff[80];
+    long long client_us;
+    if (sscanf(charMessage, "Ping %d %lld", &seq, &client_us) == 2)
+        sprintf_s(buff, "Ping %d %lld %lld", seq, client_us, (long long)Telemetry::now());
+    else
+        strcpy_s(buff, charMessage);
 
     // Send PING to all connected clients.
-    if (sendMessage(df::MessageType::CUSTOM_MESSAGE, (int)strlen(buff), buff, p_en->getSocketIndex())) {
-        LM.writeLog("Server::handleData(): PING sent to all clients.");
+    if (sendMessage(df::MessageType::CUSTOM_MESSAGE, (int)strlen(buff) + 1, buff, p_en->getSocketIndex())) {
+        countSent(df::MessageType::CUSTOM_MESSAGE, p_en->getSocketIndex());
+        BINLOG("Server::handleData(): PING echo sent to socket %d.",
+            p_en->getSocketIndex());
         return 0;
     }
     else {
@@ -210,6 +364,41 @@ int Server::handleEventNetworkCustom(const df::EventNetworkCustom* p_en) {
     return 0; // Not handled.
 }
 
+// Move client's Sword through mouse samples not yet applied.
+// Packets repeat recent samples, so skip any already applied.
+// Return 1 if message was mouse input, else 0.
+int Server::handleInput(const df::EventNetworkCustom* p_en) {
+
+    static df::Vector samples[INPUT_PACKET_MAX];
+    uint32_t first_seq;
+    int count = decodeInput(p_en->getMessage(), p_en->getBytes(),
+        &first_seq, samples, INPUT_PACKET_MAX);
+    if (count < 0)
+        return 0;
+
+    int sock_index = p_en->getSocketIndex();
+    if (sock_index < 0 || sock_index >= MAX_PLAYERS || p_sword[sock_index] == NULL)
+        return 1; // Game not started.
+
+    // Samples lost beyond redundancy show as a gap.
+    uint32_t last_seq = input_seq[sock_index];
+    if (first_seq > last_seq + 1)
+        BINLOG("Server::handleInput(): socket %d lost samples %u to %u.",
+            sock_index, last_seq + 1, first_seq - 1);
+
+    int applied = 0;
+    for (int i = 0; i < count; i++) {
+        if (first_seq + i <= last_seq)
+            continue; // Already applied.
+        p_sword[sock_index]->moveTo(samples[i]);
+        applied++;
+    }
+    if (applied > 0)
+        input_seq[sock_index] = first_seq + count - 1;
+
+    return 1;
+}
+
 // Handle close event.
 int Server::handleClose(const df::EventNetwork* p_en) {
 
@@ -5,6 +5,10 @@
 #ifndef SERVER_H
 #define SERVER_H
 
+// System includes.
+#include <stdint.h>
+#include <vector>
+
 // Engine includes.
 #include "NetworkNode.h"
 #include "EventNetworkCustom.h"
@@ -23,6 +27,7 @@ class Server : public df::NetworkNode {
  private:
   Sword *p_sword[MAX_PLAYERS];    // Sword for each client.
   Points *p_points[MAX_PLAYERS];  // Points for each client.
+  uint32_t input_seq[MAX_PLAYERS]; // Last mouse sample applied, by client.
 
  public:
   Server();
@@ -36,13 +41,41 @@ class Server : public df::NetworkNode {
   // Handle close event.
   int handleClose(const df::EventNetwork *p_en) override;
 
-  // Handle Custom EventNetwork data (Ping) from clients. 
+  // Handle Custom EventNetwork data (Ping, mouse) from clients. 
   int handleEventNetworkCustom(const df::EventNetworkCustom* p_en);
 
-private:  
-  // Handle step event.
+  // Handle step event (public for fruit-bench).
   int handleStep(const df::EventStep *p_es);
 
+  // Send DELETE for Object to all clients.
+  // Batched until end of tick if governor is merging.
+  void deleteObject(df::Object *p_o);
+
+  // Count last message sent (to client(s), -1 is all), for stats.
+  void countSent(df::MessageType type, int sock_index);
+
+private:  
+  int ping_count;  // ticks since last server PING
+  int ping_seq;    // sequence number of next server PING
+  std::vector<int> delete_ids;  // DELETEs batched this tick
+
+  // Send batched DELETEs, as few custom messages.
+  void sendDeletes();
+
+  // Send PING to all clients, for per-client round trip times.
+  void ping();
+
+  // Move client's Sword through mouse samples not yet applied.
+  // Return 1 if message was mouse input, else 0.
+  int handleInput(const df::EventNetworkCustom *p_en);
+
+
+  // Send Object, with game type tag for log, to client(s) (-1 is all).
+  void sync(df::Object *p_o, GameType type, int sock_index);
+
+  // Send Sword path control points to client(s) (-1 is all).
+  void sendPath(Sword *p_s, const std::vector<df::Vector> &points, int sock_index);
+
 };
 
 #endif
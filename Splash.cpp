@@ -11,14 +11,14 @@
 #include "WorldManager.h"
 
 // Game includes.
+#include "Effects.h"
 #include "Fruit.h"
 #include "Splash.h"
 #include "util.h"
 
 Splash::Splash() {
 
-  // Set Object attributes.
-  setVisible(false);
+  // Set Object attributes (visible, but only to draw slice trail).
   setType("Splash");
   setSolidness(df::SPECTRAL);
   registerInterest(df::STEP_EVENT);
@@ -52,6 +52,9 @@ int Splash::eventHandler(const df::Event *p_e) {
 // Handle step events.
 int Splash::step(const df::EventStep *p_s) {
 
+  // Age slice trail.
+  m_trail.step();
+
   // Time 1: Spawn Fruit. Play sound.
   if (m_time == FRUIT_TIME) {
 
@@ -81,7 +84,7 @@ int Splash::step(const df::EventStep *p_s) {
     p_f -> setAnimation(a);
 
     // Play "impact" sound.
-    play_sound("impact");
+    play_sound(SOUND_IMPACT);
   }
 
   // Time 2: Spawn Ninja. Play sound.
@@ -113,7 +116,7 @@ int Splash::step(const df::EventStep *p_s) {
     p_f -> setAnimation(a);
 
     // Play "impact" sound.
-    play_sound("impact");
+    play_sound(SOUND_IMPACT);
   }
 
   // Time 3: Slice and explode.
@@ -124,30 +127,29 @@ int Splash::step(const df::EventStep *p_s) {
 		   WM.getBoundary().getVertical() - 2);
     df::Vector p2(WM.getBoundary().getHorizontal()/2 + 4,
 		   2);
-    create_trail(p1, p2, df::CYAN);
+    create_trail(&m_trail, p1, p2, df::CYAN);
 
     // Explode fruit-splash.
     df::ObjectList ol = WM.objectsOfType("fruit-splash");
     df::Vector where = ol[0] -> getPosition();
     int index = 0; // first frame
-    df::explode(ol[0] -> getAnimation().getSprite(), index, where,
-                EXPLOSION_AGE, EXPLOSION_SPEED*3.0f, EXPLOSION_ROTATE*2.0f);
+    FX.explode(ol[0] -> getAnimation().getSprite(), index, where,
+               EXPLOSION_AGE, EXPLOSION_SPEED*3.0f, EXPLOSION_ROTATE*2.0f);
     WM.markForDelete(ol[0]);
 
     // Explode ninja-splash.
     ol = WM.objectsOfType("ninja-splash");
     where = ol[0] -> getPosition();
-    df::explode(ol[0] -> getAnimation().getSprite(), index, where,
-                EXPLOSION_AGE, EXPLOSION_SPEED*3.0f, EXPLOSION_ROTATE*2.0f);
+    FX.explode(ol[0] -> getAnimation().getSprite(), index, where,
+               EXPLOSION_AGE, EXPLOSION_SPEED*3.0f, EXPLOSION_ROTATE*2.0f);
     WM.markForDelete(ol[0]);
 
     // Explode Fruit.
-    ol = WM.solidObjects();
-    for (int i=0; i<ol.getCount(); i++)
-      WM.markForDelete(ol[i]);
+    for (int i=0; i<Registry<Fruit>::getCount(); i++)
+      WM.markForDelete(Registry<Fruit>::get(i));
 
     // Play "game start" sound.
-    play_sound("game-start");
+    play_sound(SOUND_GAME_START);
   }
 
   // Time 4: Delete everything. Set game over.
@@ -164,6 +166,11 @@ int Splash::step(const df::EventStep *p_s) {
   return 1;
 }
 
+// Draw slice trail.
+int Splash::draw() {
+  return m_trail.draw();
+}
+
 // Handle keyboard events.
 int Splash::keyboard(const df::EventKeyboard *p_k) {
 
@@ -9,6 +9,9 @@
 #include "EventStep.h"
 #include "Object.h"	
 
+// Game includes.
+#include "Trail.h"
+
 // Timing (ticks) for splash events.
 const int FRUIT_TIME = 0;
 const int NINJA_TIME = 30;
@@ -19,6 +22,7 @@ class Splash : public df::Object {
 
  private:
   int m_time;          // Count of ticks for event actions.
+  Trail m_trail;       // Slice trail.
   
   // Handle step events.
   int step(const df::EventStep *p_s);
@@ -33,6 +37,9 @@ class Splash : public df::Object {
 
   // Handle events.
   int eventHandler(const df::Event *p_e)  override;
+
+  // Draw slice trail.
+  int draw() override;
 };
  
 #endif // SPLASH_H
@@ -0,0 +1,203 @@
+//
+// Spline.cpp
+//
+
+// System includes.
+#include <string.h>
+
+// Engine includes.
+#include "utility.h"
+
+// Game includes.
+#include "Spline.h"
+
+// Point on Catmull-Rom segment p1 to p2, at t in [0, 1].
+df::Vector catmullRom(df::Vector p0, df::Vector p1, df::Vector p2,
+		      df::Vector p3, float t) {
+  float t2 = t * t;
+  float t3 = t2 * t;
+  float a = -0.5f * t3 + t2 - 0.5f * t;
+  float b = 1.5f * t3 - 2.5f * t2 + 1.0f;
+  float c = -1.5f * t3 + 2.0f * t2 + 0.5f * t;
+  float d = 0.5f * t3 - 0.5f * t2;
+  return df::Vector(a * p0.getX() + b * p1.getX() + c * p2.getX() + d * p3.getX(),
+		    a * p0.getY() + b * p1.getY() + c * p2.getY() + d * p3.getY());
+}
+
+// Distance from point p to segment a-b.
+float distanceToSegment(df::Vector p, df::Vector a, df::Vector b) {
+  float dx = b.getX() - a.getX(), dy = b.getY() - a.getY();
+  float len2 = dx * dx + dy * dy;
+  float t = 0;
+  if (len2 > 0) {
+    t = ((p.getX() - a.getX()) * dx + (p.getY() - a.getY()) * dy) / len2;
+    if (t < 0) t = 0;
+    if (t > 1) t = 1;
+  }
+  return df::distance(p, df::Vector(a.getX() + t * dx, a.getY() + t * dy));
+}
+
+SplinePath::SplinePath() {
+  m_started = false;
+}
+
+// Start curve at point.
+void SplinePath::reset(df::Vector start) {
+  m_prev = start;
+  m_last = start;
+  m_started = true;
+}
+
+// Return true once started.
+bool SplinePath::isStarted() const {
+  return m_started;
+}
+
+// Get last control point.
+df::Vector SplinePath::getLast() const {
+  return m_last;
+}
+
+// Curve from last control point to p, without start point, in
+// SPLINE_STEPS points to p_out.  Curve is not changed.
+void SplinePath::segment(df::Vector p, df::Vector *p_out) const {
+  for (int i=1; i<=SPLINE_STEPS; i++)
+    p_out[i - 1] = catmullRom(m_prev, m_last, p, p, (float) i / SPLINE_STEPS);
+}
+
+// Append control point, curve to it (as segment()) to p_out.
+void SplinePath::append(df::Vector p, df::Vector *p_out) {
+  segment(p, p_out);
+  m_prev = m_last;
+  m_last = p;
+}
+
+SplineFitter::SplineFitter(float error, int max_hold) {
+  m_error = error;
+  m_max_hold = max_hold;
+  m_hold = 0;
+  m_added = 0;
+  m_fitted = 0;
+}
+
+// Start curve at point, dropping pending samples.
+void SplineFitter::reset(df::Vector start) {
+  m_path.reset(start);
+  m_pending.clear();
+  m_hold = 0;
+  m_added = 0;
+  m_fitted = 0;
+}
+
+// Add sample (e.g., each mouse sample applied to Sword).
+void SplineFitter::add(df::Vector sample) {
+  if (!m_path.isStarted())
+    m_path.reset(sample);
+  m_pending.push_back(sample);
+  m_added += 1;
+}
+
+// Return true if segment from last control point to m_pending[j]
+// passes within error of all pending samples before it.
+bool SplineFitter::fits(int j) const {
+  df::Vector curve[SPLINE_STEPS + 1];
+  curve[0] = m_path.getLast();
+  m_path.segment(m_pending[j], curve + 1);
+  for (int i=0; i<j; i++) {
+    float best = m_error + 1;
+    for (int k=0; k<SPLINE_STEPS && best > m_error; k++) {
+      float d = distanceToSegment(m_pending[i], curve[k], curve[k + 1]);
+      if (d < best)
+	best = d;
+    }
+    if (best > m_error)
+      return false;
+  }
+  return true;
+}
+
+// Make m_pending[j] control point, dropping samples up to it.
+void SplineFitter::emit(int j, std::vector<df::Vector> &out) {
+  df::Vector curve[SPLINE_STEPS];
+  m_path.append(m_pending[j], curve);
+  out.push_back(m_pending[j]);
+  m_pending.erase(m_pending.begin(), m_pending.begin() + j + 1);
+  m_hold = 0;
+  m_fitted = 0;
+}
+
+// Once per tick: fit samples so far.  Control points to send are
+// appended to out.  Return number appended.
+int SplineFitter::step(std::vector<df::Vector> &out) {
+
+  size_t before = out.size();
+
+  // Longest segments that stay within error.  Samples checked on
+  // earlier ticks still fit (same control point), so resume after them.
+  int j = m_fitted;
+  while (j < (int) m_pending.size()) {
+    if (j > 0 && (!fits(j) || j >= SPLINE_MAX_PENDING)) {
+      emit(j - 1, out);
+      j = 0;
+    } else
+      j += 1;
+  }
+  m_fitted = (int) m_pending.size();
+
+  // Rest fit.  Send last if it waited long enough or Sword stopped.
+  if (!m_pending.empty()) {
+    m_hold += 1;
+    if (m_hold >= m_max_hold || m_added == 0)
+      emit((int) m_pending.size() - 1, out);
+  }
+
+  m_added = 0;
+  return (int) (out.size() - before);
+}
+
+// Encode message for Sword id with control points, stamped with
+// server time (Telemetry::now()).  Return message size in bytes.
+int encodeSpline(int id, int64_t time, const df::Vector *p_points,
+		 int count, std::vector<char> &buffer) {
+  SplineHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.tag, SPLINE_TAG, sizeof(SPLINE_TAG));
+  h.id = id;
+  h.time = time;
+  h.count = (uint16_t) count;
+  h.reserved = 0;
+  buffer.resize(sizeof(h) + count * 2 * sizeof(float));
+  memcpy(buffer.data(), &h, sizeof(h));
+  float *p_xy = (float *) (buffer.data() + sizeof(h));
+  for (int i=0; i<count; i++) {
+    p_xy[2 * i] = p_points[i].getX();
+    p_xy[2 * i + 1] = p_points[i].getY();
+  }
+  return (int) buffer.size();
+}
+
+// Decode message: Sword id in p_id, server time in p_time, control
+// points to p_points.
+// Return number of points, or -1 if not a spline message or bad.
+int decodeSpline(const void *p_data, int bytes, int *p_id, int64_t *p_time,
+		 df::Vector *p_points, int max) {
+  if (bytes < (int) sizeof(SplineHeader))
+    return -1;
+  SplineHeader h;
+  memcpy(&h, p_data, sizeof(h));
+  if (memcmp(h.tag, SPLINE_TAG, sizeof(SPLINE_TAG)) != 0)
+    return -1;
+  int count = h.count;
+  if (count > max ||
+      bytes < (int) (sizeof(h) + count * 2 * sizeof(float)))
+    return -1;
+  const char *p_xy = (const char *) p_data + sizeof(h);
+  for (int i=0; i<count; i++) {
+    float xy[2];
+    memcpy(xy, p_xy + i * sizeof(xy), sizeof(xy));
+    p_points[i] = df::Vector(xy[0], xy[1]);
+  }
+  *p_id = h.id;
+  *p_time = h.time;
+  return count;
+}
@@ -0,0 +1,130 @@
+//
+// Spline.h
+//
+// Sword paths relayed as Catmull-Rom control points instead of every
+// position.  The server fits each Sword's mouse samples and sends a
+// control point only once the curve through the last one can no longer
+// stay within SPLINE_ERROR of the samples (or the point has waited
+// SPLINE_MAX_HOLD ticks, or the Sword stopped).  The other player's
+// client rebuilds the same curve and trails the Sword along it.
+//
+// Segment from control point p1 to p2 uses p0 (point before p1) for
+// its start tangent and p2 itself for its end tangent (clamped), so a
+// segment is final when its end point is sent: server checks error on
+// exactly the curve the client draws.
+//
+// Message (native byte order, a CUSTOM message):
+//   SplineHeader, then float x, y for each control point.
+//
+
+#ifndef SPLINE_H
+#define SPLINE_H
+
+// System includes.
+#include <stdint.h>
+#include <vector>
+
+// Engine includes.
+#include "Vector.h"
+
+// Spline settings.
+const char SPLINE_TAG[4] = {'S', 'P', 'L', 'N'};
+const float SPLINE_ERROR = 0.5f;         // max distance from samples, spaces
+const int SPLINE_MAX_HOLD = 2;           // ticks a control point may wait
+const int SPLINE_MAX_PENDING = 256;      // samples, before forced point
+const int SPLINE_MAX_POINTS = 64;        // control points per message
+const int SPLINE_STEPS = 16;             // curve points per segment
+
+// Start of message.
+struct SplineHeader {
+  char tag[4];                           // SPLINE_TAG
+  int32_t id;                            // Sword id
+  int64_t time;                          // server send time, in us
+  uint16_t count;                        // control points
+  uint16_t reserved;
+};
+
+// Point on Catmull-Rom segment p1 to p2, at t in [0, 1].
+df::Vector catmullRom(df::Vector p0, df::Vector p1, df::Vector p2,
+		      df::Vector p3, float t);
+
+// Distance from point p to segment a-b.
+float distanceToSegment(df::Vector p, df::Vector a, df::Vector b);
+
+// Curve through control points, one segment at a time.
+class SplinePath {
+
+ private:
+  df::Vector m_prev;                     // control point before last
+  df::Vector m_last;                     // last control point
+  bool m_started;
+
+ public:
+
+  // Constructor.
+  SplinePath();
+
+  // Start curve at point.
+  void reset(df::Vector start);
+
+  // Return true once started.
+  bool isStarted() const;
+
+  // Get last control point.
+  df::Vector getLast() const;
+
+  // Curve from last control point to p, without start point, in
+  // SPLINE_STEPS points to p_out.  Curve is not changed.
+  void segment(df::Vector p, df::Vector *p_out) const;
+
+  // Append control point, curve to it (as segment()) to p_out.
+  void append(df::Vector p, df::Vector *p_out);
+};
+
+// Server: fits one Sword's samples to control points.
+class SplineFitter {
+
+ private:
+  SplinePath m_path;                     // as client will draw it
+  std::vector<df::Vector> m_pending;     // samples past last control point
+  int m_hold;                            // ticks pending has waited
+  int m_added;                           // samples added since last step
+  int m_fitted;                          // pending known to fit, resume there
+  float m_error;                         // max distance, spaces
+  int m_max_hold;                        // max ticks waiting
+
+  // Return true if segment from last control point to m_pending[j]
+  // passes within error of all pending samples before it.
+  bool fits(int j) const;
+
+  // Make m_pending[j] control point, dropping samples up to it.
+  void emit(int j, std::vector<df::Vector> &out);
+
+ public:
+
+  // Constructor.
+  SplineFitter(float error = SPLINE_ERROR, int max_hold = SPLINE_MAX_HOLD);
+
+  // Start curve at point, dropping pending samples.
+  void reset(df::Vector start);
+
+  // Add sample (e.g., each mouse sample applied to Sword).
+  void add(df::Vector sample);
+
+  // Once per tick: fit samples so far.  Control points to send are
+  // appended to out.  Return number appended.
+  int step(std::vector<df::Vector> &out);
+};
+
+// Encode message for Sword id with control points, stamped with
+// server time (Telemetry::now()).  Return message size in bytes.
+int encodeSpline(int id, int64_t time, const df::Vector *p_points,
+		 int count, std::vector<char> &buffer);
+
+// Decode message: Sword id in p_id, server time in p_time, control
+// points to p_points.
+// Return number of points, or -1 if not a spline message or bad.
+int decodeSpline(const void *p_data, int bytes, int *p_id, int64_t *p_time,
+		 df::Vector *p_points, int max);
+
+#endif // SPLINE_H
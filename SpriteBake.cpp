@@ -0,0 +1,89 @@
+//
+// SpriteBake.cpp
+//
+
+// System includes.
+#include <map>
+
+// Engine includes.
+#include "Frame.h"
+#include "utility.h"
+
+// Game includes.
+#include "SpriteBake.h"
+
+// Baked sprites, by sprite (sprites live as long as ResourceManager).
+static std::map<const df::Sprite *, BakedSprite *> s_baked;
+
+// Bake every frame of sprite into runs of opaque characters.
+static BakedSprite *bake(const df::Sprite *p_sprite) {
+
+  BakedSprite *p_b = new BakedSprite;
+  p_b -> width = p_sprite -> getWidth();
+  p_b -> height = p_sprite -> getHeight();
+  p_b -> frame_count = p_sprite -> getFrameCount();
+  p_b -> slowdown = p_sprite -> getSlowdown();
+  char transparency = p_sprite -> getTransparency();
+  unsigned char r, g, b;
+  df::colorToRGB(p_sprite -> getColor(), r, g, b);
+
+  for (int f=0; f<p_b -> frame_count; f++) {
+    p_b -> first.push_back((int) p_b -> runs.size());
+
+    df::Frame frame = p_sprite -> getFrame(f);
+    std::string str = frame.getString();
+    int width = frame.getWidth();
+    int height = frame.getHeight();
+
+    // Frame is centered at position (as Frame::draw()).
+    int x_offset = width / 2;
+    int y_offset = height / 2;
+
+    for (int y=0; y<height; y++) {
+      int x = 0;
+      while (x < width) {
+	char ch = str[y * width + x];
+	if (ch == ' ' || (transparency && ch == transparency)) {
+	  x++;
+	  continue;
+	}
+	GlyphRun run;
+	run.x = (short) (x - x_offset);
+	run.y = (short) (y - y_offset);
+	run.r = r;
+	run.g = g;
+	run.b = b;
+	run.start = (int) p_b -> chars.size();
+	while (x < width) {
+	  ch = str[y * width + x];
+	  if (ch == ' ' || (transparency && ch == transparency))
+	    break;
+	  p_b -> chars += ch;
+	  x++;
+	}
+	run.length = (short) (p_b -> chars.size() - run.start);
+	p_b -> runs.push_back(run);
+      }
+    }
+  }
+  p_b -> first.push_back((int) p_b -> runs.size());
+
+  return p_b;
+}
+
+// Get baked sprite, baking it on first call.
+// Return NULL if sprite is NULL or has no frames.
+const BakedSprite *bakeSprite(const df::Sprite *p_sprite) {
+
+  if (!p_sprite || p_sprite -> getFrameCount() == 0)
+    return NULL;
+
+  std::map<const df::Sprite *, BakedSprite *>::iterator it =
+    s_baked.find(p_sprite);
+  if (it != s_baked.end())
+    return it -> second;
+
+  BakedSprite *p_b = bake(p_sprite);
+  s_baked[p_sprite] = p_b;
+  return p_b;
+}
@@ -0,0 +1,46 @@
+//
+// SpriteBake.h
+//
+// Sprite frames baked once into runs of opaque glyphs, so drawing (or
+// exploding) a frame is a loop over spans: no Frame or string copies
+// and no per-character transparency test.  Sprites do not change at
+// run time, so each is baked on first use and kept until exit.
+//
+
+#ifndef SPRITE_BAKE_H
+#define SPRITE_BAKE_H
+
+// System includes.
+#include <string>
+#include <vector>
+
+// Engine includes.
+#include "Sprite.h"
+
+// Span of opaque characters in one row of a frame.
+struct GlyphRun {
+  short x, y;                   // offset from frame center, in spaces
+  short length;                 // characters in run
+  unsigned char r, g, b;        // color
+  int start;                    // first character, in BakedSprite chars
+};
+
+// All frames of one sprite.
+struct BakedSprite {
+  int width, height;            // frame size, in spaces
+  int frame_count;
+  int slowdown;                 // animation slowdown (0 = stop)
+  std::vector<int> first;       // first run of each frame, then end
+  std::vector<GlyphRun> runs;   // all frames' runs, in frame order
+  std::string chars;            // run characters, back to back
+
+  // Get runs of frame index: [getRuns(index), getRuns(index) + getRunCount(index)).
+  const GlyphRun *getRuns(int index) const { return runs.data() + first[index]; }
+  int getRunCount(int index) const { return first[index+1] - first[index]; }
+};
+
+// Get baked sprite, baking it on first call.
+// Return NULL if sprite is NULL or has no frames.
+const BakedSprite *bakeSprite(const df::Sprite *p_sprite);
+
+#endif // SPRITE_BAKE_H
@@ -0,0 +1,282 @@
+//
+// StatsServer.cpp
+//
+
+// System includes.
+#if defined(_WIN32) || defined(_WIN64)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+#define close_socket closesocket
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int socket_t;
+#define INVALID_SOCKET (-1)
+#define close_socket close
+#endif
+#include <stdio.h>
+#include <string.h>
+
+// Engine includes.
+#include "GameManager.h"
+#include "LogManager.h"
+#include "NetworkManager.h"
+
+// Game includes.
+#include "BinLog.h"
+#include "Fruit.h"
+#include "Governor.h"
+#include "Profiler.h"
+#include "Registry.h"
+#include "StatsServer.h"
+#include "Telemetry.h"
+
+// Message type names, for snapshot.
+static const char *MESSAGE_NAME[NUM_MESSAGE_TYPES] = {
+  "sync",
+  "delete",
+  "game_over",
+  "keyboard",
+  "mouse",
+  "custom",
+};
+
+StatsServer::StatsServer() {
+  memset(&m_sent, 0, sizeof(m_sent));
+  memset(&m_received, 0, sizeof(m_received));
+  m_last_sent = m_sent;
+  m_last_received = m_received;
+  m_last_time = std::chrono::steady_clock::now();
+  m_ticks = 0;
+  m_snapshot = "{}\n";
+  m_running = false;
+  m_listen = (long long) INVALID_SOCKET;
+}
+
+// Get the one and only instance of the StatsServer.
+StatsServer &StatsServer::getInstance() {
+  static StatsServer stats_server;
+  return stats_server;
+}
+
+// Listen on loopback port and start serving thread.
+// Return 0 if ok, else -1.
+int StatsServer::startUp(int port) {
+
+  if (m_running)
+    return 0;
+
+  socket_t s = socket(AF_INET, SOCK_STREAM, 0);
+  if (s == INVALID_SOCKET) {
+    LM.writeLog("StatsServer::startUp(): Error! Unable to create socket.");
+    return -1;
+  }
+  int on = 1;
+  setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char *) &on, sizeof(on));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((unsigned short) port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(s, (struct sockaddr *) &addr, sizeof(addr)) != 0 ||
+      listen(s, 4) != 0) {
+    LM.writeLog("StatsServer::startUp(): Error! Unable to listen on port %d.",
+		port);
+    close_socket(s);
+    return -1;
+  }
+
+  m_listen = (long long) s;
+  m_running = true;
+  m_thread = std::thread(&StatsServer::serve, this);
+
+  LM.writeLog("StatsServer::startUp(): Stats at http://127.0.0.1:%d/", port);
+  return 0;
+}
+
+// Stop serving thread and close socket.
+void StatsServer::shutDown() {
+  if (!m_running)
+    return;
+  m_running = false;
+  m_thread.join();
+  close_socket((socket_t) m_listen);
+  m_listen = (long long) INVALID_SOCKET;
+}
+
+// Count message sent (bytes over all recipients).
+void StatsServer::countSent(df::MessageType type, int bytes) {
+  int i = (int) type;
+  if (i < 0 || i >= NUM_MESSAGE_TYPES)
+    return;
+  m_sent.messages[i] += 1;
+  m_sent.bytes[i] += bytes;
+}
+
+// Count message received.
+void StatsServer::countReceived(df::MessageType type, int bytes) {
+  int i = (int) type;
+  if (i < 0 || i >= NUM_MESSAGE_TYPES)
+    return;
+  m_received.messages[i] += 1;
+  m_received.bytes[i] += bytes;
+}
+
+// Call once per tick, to publish snapshot every second.
+// If serving thread is copying snapshot, try again next tick.
+void StatsServer::step() {
+
+  m_ticks += 1;
+  if (!m_running || m_ticks < STATS_PUBLISH_TICKS)
+    return;
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(now - m_last_time).count();
+  std::string json = snapshot(seconds);
+
+  std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+  if (!lock.owns_lock())
+    return;
+  m_snapshot.swap(json);
+  m_last_sent = m_sent;
+  m_last_received = m_received;
+  m_last_time = now;
+  m_ticks = 0;
+}
+
+// Build JSON snapshot from current counters.
+std::string StatsServer::snapshot(double seconds) {
+
+  if (seconds <= 0.0)
+    seconds = 1.0;
+
+  char buff[256];
+  std::string json = "{\n";
+
+  snprintf(buff, sizeof(buff),
+	   "  \"step\": %d,\n  \"players\": %d,\n  \"fruit\": %d,\n",
+	   GM.getStepCount(), NM.getNumConnections(),
+	   Registry<Fruit>::getCount());
+  json += buff;
+
+  snprintf(buff, sizeof(buff),
+	   "  \"governor\": {\"level\": \"%s\", \"tick_ms\": %.1f, \"work_ms\": %.1f},\n",
+	   Governor::levelName(GOV.getLevel()), GOV.getTickTime(),
+	   GOV.getWorkTime());
+  json += buff;
+
+  // Tick phases.
+  json += "  \"phases_us\": {";
+  for (int i=0; i<NUM_PROFILE_PHASES; i++) {
+    const ProfileSummary &s = PROF.getSummary((ProfilePhase) i);
+    snprintf(buff, sizeof(buff),
+	     "%s\n    \"%s\": {\"count\": %u, \"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f}",
+	     i ? "," : "", profilePhaseName((ProfilePhase) i), s.count,
+	     s.count ? s.p50 : 0.0f, s.count ? s.p99 : 0.0f,
+	     s.count ? s.max : 0.0f);
+    json += buff;
+  }
+  json += "\n  },\n";
+
+  // Message rates, each direction.
+  const MessageCounts *p_now[2] = {&m_sent, &m_received};
+  const MessageCounts *p_last[2] = {&m_last_sent, &m_last_received};
+  const char *direction[2] = {"sent_per_s", "received_per_s"};
+  for (int d=0; d<2; d++) {
+    json += "  \"";
+    json += direction[d];
+    json += "\": {";
+    for (int i=0; i<NUM_MESSAGE_TYPES; i++) {
+      snprintf(buff, sizeof(buff),
+	       "%s\n    \"%s\": {\"messages\": %.1f, \"bytes\": %.1f}",
+	       i ? "," : "", MESSAGE_NAME[i],
+	       (p_now[d] -> messages[i] - p_last[d] -> messages[i]) / seconds,
+	       (p_now[d] -> bytes[i] - p_last[d] -> bytes[i]) / seconds);
+      json += buff;
+    }
+    json += "\n  },\n";
+  }
+
+  // Per-client round trip times.
+  json += "  \"clients\": [";
+  for (int i=0; i<NM.getNumConnections(); i++) {
+    const ConnectionTelemetry *p_c = TM.get(i);
+    if (!p_c)
+      break;
+    snprintf(buff, sizeof(buff),
+	     "%s\n    {\"socket\": %d, \"rtt_ms\": %.1f, \"ewma_ms\": %.1f, \"p95_ms\": %.1f, \"jitter_ms\": %.1f, \"loss\": %.3f}",
+	     i ? "," : "", i, p_c -> getLast(), p_c -> getEwma(),
+	     p_c -> getPercentile(95), p_c -> getJitter(), p_c -> getLoss());
+    json += buff;
+  }
+  json += "\n  ],\n";
+
+  // Queue depths.
+  snprintf(buff, sizeof(buff),
+	   "  \"queues\": {\"binlog_pending\": %d}\n", BL.getPending());
+  json += buff;
+
+  json += "}\n";
+  return json;
+}
+
+// Serving thread body: answer each request with latest snapshot.
+void StatsServer::serve() {
+
+  socket_t listen_s = (socket_t) m_listen;
+
+  while (m_running) {
+
+    // Wait for connection, with timeout to notice shutdown.
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(listen_s, &fds);
+    struct timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = STATS_POLL_MS * 1000;
+    if (select((int) listen_s + 1, &fds, NULL, NULL, &tv) <= 0)
+      continue;
+
+    socket_t s = accept(listen_s, NULL, NULL);
+    if (s == INVALID_SOCKET)
+      continue;
+
+    // Read (and ignore) request.  Client that sends nothing in time
+    // (or closes) is dropped, so can't stall thread.
+    FD_ZERO(&fds);
+    FD_SET(s, &fds);
+    tv.tv_sec = 0;
+    tv.tv_usec = STATS_POLL_MS * 1000;
+    char request[1024];
+    if (select((int) s + 1, &fds, NULL, NULL, &tv) <= 0 ||
+	recv(s, request, sizeof(request), 0) <= 0) {
+      close_socket(s);
+      continue;
+    }
+
+    std::string body;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      body = m_snapshot;
+    }
+    std::string response = "HTTP/1.0 200 OK\r\n"
+      "Content-Type: application/json\r\n"
+      "Content-Length: " + std::to_string(body.size()) + "\r\n"
+      "Connection: close\r\n\r\n" + body;
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+      int n = (int) send(s, response.c_str() + sent,
+			 (int) (response.size() - sent), 0);
+      if (n <= 0)
+	break;
+      sent += n;
+    }
+    close_socket(s);
+  }
+}
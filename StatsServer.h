@@ -0,0 +1,88 @@
+//
+// StatsServer.h
+//
+// Live server counters over loopback HTTP, for operators (see
+// fruit-stats).  Once a second the game thread builds a JSON snapshot:
+// players, live Fruit, governor level, per-phase tick times, messages
+// and bytes per second by type, per-client RTT and queue depths.  A
+// background thread serves the latest snapshot to any GET, so
+// requests never block the game loop.
+//
+
+#ifndef STATS_SERVER_H
+#define STATS_SERVER_H
+
+// System includes.
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Engine includes.
+#include "NetworkNode.h"
+
+// StatsServer settings.
+const int STATS_PORT = 9877;              // loopback only
+const int STATS_PUBLISH_TICKS = 30;       // ticks between snapshots
+const int STATS_POLL_MS = 200;            // accept timeout, for shutdown
+const int NUM_MESSAGE_TYPES = 6;          // df::MessageType, less UNDEFINED
+
+// Message counters for one direction.
+struct MessageCounts {
+  long long messages[NUM_MESSAGE_TYPES];
+  long long bytes[NUM_MESSAGE_TYPES];
+};
+
+// Two-letter acronym for easier access to stats server.
+#define STATS StatsServer::getInstance()
+
+class StatsServer {
+
+ private:
+  StatsServer();                          // Private since a singleton.
+  StatsServer(StatsServer const&);        // Don't allow copy.
+  void operator=(StatsServer const&);     // Don't allow assignment.
+
+  MessageCounts m_sent;                   // totals, game thread only
+  MessageCounts m_received;
+  MessageCounts m_last_sent;              // totals at last snapshot
+  MessageCounts m_last_received;
+  std::chrono::steady_clock::time_point m_last_time;
+  int m_ticks;                            // ticks since last snapshot
+
+  std::mutex m_mutex;                     // guards m_snapshot
+  std::string m_snapshot;                 // latest JSON
+  std::atomic<bool> m_running;            // true while serving
+  std::thread m_thread;                   // serving thread
+  long long m_listen;                     // listening socket
+
+  // Serving thread body.
+  void serve();
+
+  // Build JSON snapshot from current counters.
+  std::string snapshot(double seconds);
+
+ public:
+
+  // Get the one and only instance of the StatsServer.
+  static StatsServer &getInstance();
+
+  // Listen on loopback port and start serving thread.
+  // Return 0 if ok, else -1.
+  int startUp(int port = STATS_PORT);
+
+  // Stop serving thread and close socket.
+  void shutDown();
+
+  // Count message sent (bytes over all recipients).
+  void countSent(df::MessageType type, int bytes);
+
+  // Count message received.
+  void countReceived(df::MessageType type, int bytes);
+
+  // Call once per tick, to publish snapshot every second.
+  void step();
+};
+
+#endif // STATS_SERVER_H
@@ -3,9 +3,7 @@
 //
 
 // Engine includes.
-#include "DisplayManager.h"
 #include "EventCollision.h"
-#include "EventView.h"
 #include "GameManager.h"
 #include "LogManager.h"
 #include "NetworkManager.h"
@@ -13,10 +11,11 @@
 
 // Game includes.
 #include "Client.h"
+#include "Compositor.h"
 #include "Fruit.h"
 #include "Grocer.h"
 #include "Kudos.h"
-#include "Points.h"
+#include "Profiler.h"
 #include "Sword.h"
 #include "Timer.h"
 #include "util.h"
@@ -25,7 +24,7 @@ Sword::Sword() {
 
     setType(SWORD_STRING);
     setSolidness(df::SPECTRAL);
-    setAltitude(df::MAX_ALTITUDE); // Make Sword in foreground.
+    setAltitude(FOREGROUND_ALTITUDE); // Make Sword in foreground.
 
     // Start sword in center of world.
     df::Vector p(WM.getBoundary().getHorizontal() / 2,
@@ -45,6 +44,30 @@ Sword::Sword() {
     m_old_position = getPosition();
     m_sliced = 0;
     m_old_sliced = 0;
+
+    // Only the client draws trails.
+    m_p_trail = NULL;
+    if (NM.isServer() == false)
+        m_p_trail = new Trail();
+
+    // Only the server slices, along every mouse sample in a tick.
+    m_p_path = NULL;
+    m_p_fitter = NULL;
+    if (NM.isServer() == true) {
+        m_p_path = new Polyline();
+        m_p_path->start(getPosition());
+        m_p_fitter = new SplineFitter();
+        m_p_fitter->reset(getPosition());
+    }
+
+    Registry<Sword>::insert(this, SWORD_TYPE);
+}
+
+Sword::~Sword() {
+    Registry<Sword>::remove(this);
+    delete m_p_trail;
+    delete m_p_path;
+    delete m_p_fitter;
 }
 
 void Sword::setColor(df::Color new_color) {
@@ -86,39 +109,45 @@ int Sword::getSocketIndex() const {
 // Handle step event.
 int Sword::step(const df::EventStep* p_e) {
 
-    // If didn't move, nothing to do.
-    if (m_old_position == getPosition()) {
-        m_sliced = 0;
-        return 1;
-    }
+    // Age trail, even if not moving.
+    if (m_p_trail)
+        m_p_trail->step();
 
     // If client, make a trail, nothing else.
     if (NM.isServer() == false) {
-        create_trail(getPosition(), m_old_position, getColor());
+        if (m_old_position == getPosition()) {
+            m_sliced = 0;
+            return 1;
+        }
+        create_trail(m_p_trail, getPosition(), m_old_position, getColor());
         m_old_position = getPosition();
         return 1;
     }
 
+    // Path ends where sword is (in case moved other than by mouse).
+    m_p_path->add(getPosition());
+
+    // If didn't move, nothing to do.
+    if (m_p_path->getCount() < 2) {
+        m_sliced = 0;
+        return 1;
+    }
+
     // Only the Server checks for slicing and adjusts points.
+    PROFILE_SCOPE(PROFILE_SLICE);
 
     ////////////////////////////////////////////////////
     // SLICING
-    // Check if line intersect any Fruit.
-    df::Line line(getPosition(), m_old_position);
-    df::ObjectList ol = WM.solidObjects();
-
-    for (int i = 0; i < ol.getCount(); i++) {
-
-        // Only slice Fruit.
-        if (!(dynamic_cast <Fruit*> (ol[i])))
-            continue;
+    // Check if path since last tick intersects any Fruit.
+    for (int i = 0; i < Registry<Fruit>::getCount(); i++) {
 
-        // If line from previous position intersects --> slice!
-        df::Object* p_o = ol[i];
+        // If path from previous position intersects --> slice!
+        df::Object* p_o = Registry<Fruit>::get(i);
         df::Box box = getWorldBox(p_o);
-        if (lineIntersectsBox(line, box)) {
+        if (m_p_path->intersects(box)) {
             df::EventCollision c(this, p_o, p_o->getPosition());
-            p_o->eventHandler(&c);
+            if (p_o->eventHandler(&c) == 0)
+                continue; // Already sliced or missed.
             m_sliced += 1;
 
             // Kudos for combo, sent to just the player that earned.
@@ -127,39 +156,73 @@ int Sword::step(const df::EventStep* p_e) {
 
             m_old_sliced = m_sliced;
 
-        } // End of box-line check.
+        } // End of box-path check.
 
-    } // End of loop through all objects.
+    } // End of loop through all Fruit.
 
     ////////////////////////////////////////////////////
     // POINTS
-    // Compute how far travel.
-    float dist = df::distance(getPosition(), m_old_position);
+    // Compute how far travel, along path.
+    float dist = m_p_path->getLength();
 
     // If travel far enough, play "swipe" sound.
     if (dist > 15) {
-        std::string sound = "swipe-" + std::to_string(rand() % 7 + 1);
-        play_sound(sound);
-    }
-
-    // Lose points for distance traveled.
-    int penalty = -1 * (int)(dist / 10.0f);
-    if (penalty != 0) {
-        std::string s = POINTS_STRING;
-        s += ":";
-        s += df::toString(getColor());
-        df::EventView ev(s, penalty, true);
-        WM.onEvent(&ev);
+        play_sound(SOUND_SWIPE + rand() % NUM_SWIPES);
     }
 
     m_old_position = getPosition();
+    m_p_path->start(m_old_position);
 
     return 1;
 }
 
+// Move to position (server), adding it to path for slicing.
+// Every sample is kept, not just latest.
+void Sword::moveTo(df::Vector position) {
+    setPosition(position);
+    if (m_p_path)
+        m_p_path->add(getPosition());
+    if (m_p_fitter)
+        m_p_fitter->add(getPosition());
+}
+
+// Fit path moved since last call (server), appending control
+// points to relay to out.  Return number appended.
+int Sword::fitPath(std::vector<df::Vector>& out) {
+    if (!m_p_fitter)
+        return 0;
+    return m_p_fitter->step(out);
+}
+
+// Move along curve through relayed control points (client).
+void Sword::followSpline(const df::Vector* p_points, int count) {
+    if (!m_spline.isStarted())
+        m_spline.reset(getPosition());
+    df::Vector curve[SPLINE_STEPS];
+    for (int i = 0; i < count; i++) {
+        m_spline.append(p_points[i], curve);
+        moveAlong(curve, SPLINE_STEPS);
+    }
+}
+
+// Move along path (client), trailing through every point.
+void Sword::moveAlong(const df::Vector *p_path, int count) {
+    if (count <= 0)
+        return;
+    df::Vector from = getPosition();
+    for (int i = 0; i < count; i++) {
+        create_trail(m_p_trail, p_path[i], from, getColor());
+        from = p_path[i];
+    }
+    setPosition(from);
+    m_old_position = from; // Trail done, so step() has nothing to add.
+}
+
 // Handle network mouse event.
 int Sword::mouseNetwork(const df::EventMouseNetwork* p_e) {
 
+    PROFILE_SCOPE(PROFILE_NETWORK);
+
     // Mouse not for this Sword.
     if (p_e->getSocketIndex() != this->getSocketIndex())
         return 0;
@@ -168,17 +231,24 @@ int Sword::mouseNetwork(const df::EventMouseNetwork* p_e) {
     LM.writeLog(1, "Sword::mouseNetwork():: mouse xy: %s",
         p_e->getMousePosition().toString().c_str());    
 
-    setPosition(p_e->getMousePosition());
+    moveTo(p_e->getMousePosition());
 
     return 1;
 }
 
 // Draw sword on window.
 int Sword::draw() {
-    if (NM.isServer() == false)
-        return DM.drawCh(getPosition(), SWORD_CHAR, m_color);
-    else
+    if (NM.isServer() == true)
         return 0;
+
+    PROFILE_SCOPE(PROFILE_DRAW);
+
+    // Trail first, so sword is on top.
+    if (m_p_trail)
+        m_p_trail->draw();
+
+    CM.put(getPosition(), SWORD_CHAR, m_color);
+    return 0;
 }
 
 int Sword::serialize(std::stringstream* p_ss, unsigned int attr) {
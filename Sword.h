@@ -11,10 +11,16 @@
 #include "EventStep.h"
 #include "Object.h"
 
+// Game includes.
+#include "Polyline.h"
+#include "Registry.h"
+#include "Spline.h"
+#include "Trail.h"
+
 #define SWORD_CHAR '+'
 const std::string SWORD_STRING = "Sword";
 
-class Sword : public df::Object {
+class Sword : public df::Object, public Registered {
 
  private:
   df::Color m_color;         // trail color
@@ -22,6 +28,10 @@ class Sword : public df::Object {
   int m_sliced;		     // fruits sliced this move
   int m_old_sliced;	     // previous sliced
   int m_sock_index;	     // socket index at server (doesn't need to be serialized)
+  Trail *m_p_trail;	     // trail samples (client only, not serialized)
+  Polyline *m_p_path;	     // path this tick (server only, not serialized)
+  SplineFitter *m_p_fitter;  // path to relay (server only, not serialized)
+  SplinePath m_spline;	     // relayed path (client only, not serialized)
   
   // Handle step event.
   int step(const df::EventStep *p_e);
@@ -34,6 +44,9 @@ class Sword : public df::Object {
   // Constructor.
   Sword();
 
+  // Destructor.
+  ~Sword();
+
   // Handle events.
   int eventHandler(const df::Event *p_e) override;
 
@@ -49,6 +62,19 @@ class Sword : public df::Object {
   // Get socket index.
   int getSocketIndex() const;
   
+  // Move to position (server), adding it to path for slicing.
+  void moveTo(df::Vector position);
+
+  // Move along path (client), trailing through every point.
+  void moveAlong(const df::Vector *p_path, int count);
+
+  // Fit path moved since last call (server), appending control
+  // points to relay to out.  Return number appended.
+  int fitPath(std::vector<df::Vector> &out);
+
+  // Move along curve through relayed control points (client).
+  void followSpline(const df::Vector *p_points, int count);
+
   // Draw.
   int draw(void) override;
   
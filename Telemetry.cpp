@@ -0,0 +1,221 @@
+//
+// Telemetry.cpp
+//
+
+// System includes.
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+
+// Engine includes.
+#include "GameManager.h"
+#include "LogManager.h"
+
+// Game includes.
+#include "Telemetry.h"
+
+ConnectionTelemetry::ConnectionTelemetry() {
+  m_rtt_count = 0;
+  m_rtt_next = 0;
+  m_outcome_count = 0;
+  m_outcome_next = 0;
+  for (int i=0; i<TELEMETRY_PENDING; i++)
+    m_pending[i].seq = -1;
+  m_ewma = 0.0f;
+  m_jitter = 0.0f;
+  m_last = 0.0f;
+}
+
+// Add outcome (lost or not) to window.
+void ConnectionTelemetry::addOutcome(bool lost) {
+  m_lost[m_outcome_next] = lost;
+  m_outcome_next = (m_outcome_next + 1) % TELEMETRY_WINDOW;
+  if (m_outcome_count < TELEMETRY_WINDOW)
+    m_outcome_count += 1;
+}
+
+// Note ping seq sent at time.
+// If no free slot, oldest pending ping is counted as lost.
+void ConnectionTelemetry::sent(int seq, int64_t now_us) {
+  expire(now_us);
+  int slot = 0;
+  for (int i=0; i<TELEMETRY_PENDING; i++) {
+    if (m_pending[i].seq == -1) {
+      slot = i;
+      break;
+    }
+    if (m_pending[i].sent_us < m_pending[slot].sent_us)
+      slot = i;
+  }
+  if (m_pending[slot].seq != -1)
+    addOutcome(true);
+  m_pending[slot].seq = seq;
+  m_pending[slot].sent_us = now_us;
+}
+
+// Note echo of ping seq (sent at sent_us) received at time.
+// Return RTT in ms, or -1 if seq unknown (late, already lost).
+float ConnectionTelemetry::received(int seq, int64_t sent_us, int64_t now_us) {
+
+  int slot = -1;
+  for (int i=0; i<TELEMETRY_PENDING; i++)
+    if (m_pending[i].seq == seq)
+      slot = i;
+  if (slot == -1)
+    return -1.0f;
+  m_pending[slot].seq = -1;
+  addOutcome(false);
+
+  float rtt = (now_us - sent_us) / 1000.0f;
+
+  // Smoothed RTT and jitter (mean RTT change), first sample seeds.
+  if (m_rtt_count == 0) {
+    m_ewma = rtt;
+    m_jitter = 0.0f;
+  } else {
+    m_ewma += TELEMETRY_EWMA_GAIN * (rtt - m_ewma);
+    m_jitter += TELEMETRY_JITTER_GAIN * (fabsf(rtt - m_last) - m_jitter);
+  }
+  m_last = rtt;
+
+  m_rtt[m_rtt_next] = rtt;
+  m_rtt_next = (m_rtt_next + 1) % TELEMETRY_WINDOW;
+  if (m_rtt_count < TELEMETRY_WINDOW)
+    m_rtt_count += 1;
+
+  return rtt;
+}
+
+// Mark pings with no echo after timeout as lost.
+void ConnectionTelemetry::expire(int64_t now_us) {
+  for (int i=0; i<TELEMETRY_PENDING; i++)
+    if (m_pending[i].seq != -1 &&
+	now_us - m_pending[i].sent_us > TELEMETRY_TIMEOUT_US) {
+      m_pending[i].seq = -1;
+      addOutcome(true);
+    }
+}
+
+// Get number of RTT samples in window.
+int ConnectionTelemetry::getCount() const {
+  return m_rtt_count;
+}
+
+// Get last RTT (ms).
+float ConnectionTelemetry::getLast() const {
+  return m_last;
+}
+
+// Get min RTT in window (ms).
+float ConnectionTelemetry::getMin() const {
+  if (m_rtt_count == 0)
+    return 0.0f;
+  return *std::min_element(m_rtt, m_rtt + m_rtt_count);
+}
+
+// Get smoothed RTT (ms).
+float ConnectionTelemetry::getEwma() const {
+  return m_ewma;
+}
+
+// Get RTT at percentile [0, 100] of window (ms).
+float ConnectionTelemetry::getPercentile(float percentile) const {
+  if (m_rtt_count == 0)
+    return 0.0f;
+  float sorted[TELEMETRY_WINDOW];
+  std::copy(m_rtt, m_rtt + m_rtt_count, sorted);
+  int rank = (int) ceilf(percentile / 100.0f * m_rtt_count) - 1;
+  rank = std::max(0, std::min(rank, m_rtt_count - 1));
+  std::nth_element(sorted, sorted + rank, sorted + m_rtt_count);
+  return sorted[rank];
+}
+
+// Get jitter (ms).
+float ConnectionTelemetry::getJitter() const {
+  return m_jitter;
+}
+
+// Get fraction of pings in window lost [0, 1].
+float ConnectionTelemetry::getLoss() const {
+  if (m_outcome_count == 0)
+    return 0.0f;
+  int lost = 0;
+  for (int i=0; i<m_outcome_count; i++)
+    if (m_lost[i])
+      lost += 1;
+  return (float) lost / m_outcome_count;
+}
+
+Telemetry::Telemetry() {
+  m_p_file = NULL;
+}
+
+Telemetry::~Telemetry() {
+  if (m_p_file)
+    fclose(m_p_file);
+}
+
+// Get the one and only instance of the Telemetry.
+Telemetry &Telemetry::getInstance() {
+  static Telemetry telemetry;
+  return telemetry;
+}
+
+// Get current time, in microseconds.
+int64_t Telemetry::now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>
+    (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Open CSV time series file (one row per RTT sample).
+// Return 0 if ok, else -1.
+int Telemetry::open(std::string filename) {
+
+  if (m_p_file)
+    fclose(m_p_file);
+
+  m_p_file = fopen(filename.c_str(), "w");
+  if (!m_p_file) {
+    LM.writeLog("Telemetry::open(): Error! Unable to open '%s'.",
+		filename.c_str());
+    return -1;
+  }
+
+  fprintf(m_p_file, "step,connection,seq,rtt_ms,min_ms,ewma_ms,p50_ms,p95_ms,p99_ms,jitter_ms,loss\n");
+  return 0;
+}
+
+// Note ping seq sent on connection.
+void Telemetry::sent(int connection, int seq) {
+  if (connection < 0 || connection >= TELEMETRY_CONNECTIONS)
+    return;
+  m_connection[connection].sent(seq, now());
+}
+
+// Note echo of ping seq (sent at sent_us) received on connection.
+// Return RTT in ms, or -1 if unknown (late, already lost).
+float Telemetry::received(int connection, int seq, int64_t sent_us) {
+
+  if (connection < 0 || connection >= TELEMETRY_CONNECTIONS)
+    return -1.0f;
+
+  ConnectionTelemetry &c = m_connection[connection];
+  float rtt = c.received(seq, sent_us, now());
+  if (rtt < 0.0f || !m_p_file)
+    return rtt;
+
+  fprintf(m_p_file, "%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+	  GM.getStepCount(), connection, seq, rtt,
+	  c.getMin(), c.getEwma(), c.getPercentile(50), c.getPercentile(95),
+	  c.getPercentile(99), c.getJitter(), c.getLoss());
+  fflush(m_p_file);
+
+  return rtt;
+}
+
+// Get stats for connection (NULL if out of range).
+const ConnectionTelemetry *Telemetry::get(int connection) const {
+  if (connection < 0 || connection >= TELEMETRY_CONNECTIONS)
+    return NULL;
+  return &m_connection[connection];
+}
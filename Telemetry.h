@@ -0,0 +1,127 @@
+//
+// Telemetry.h
+//
+// Round-trip time (RTT) telemetry for each connection, from ping
+// echoes: min, EWMA, p50/p95/p99 and jitter over a rolling window,
+// plus loss (pings with no echo within a timeout).  Game code can read
+// the stats for adaptive decisions.  Each sample is also appended to a
+// CSV time series for offline latency evaluation.
+//
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+// System includes.
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+// Telemetry settings.
+const int TELEMETRY_CONNECTIONS = 8;      // max connections tracked
+const int TELEMETRY_WINDOW = 64;          // RTT samples kept (~30 s)
+const int TELEMETRY_PENDING = 32;         // pings awaiting echo
+const int64_t TELEMETRY_TIMEOUT_US = 2000000; // echo later than this is lost
+const float TELEMETRY_EWMA_GAIN = 0.125f; // as TCP smoothed RTT
+const float TELEMETRY_JITTER_GAIN = 0.0625f; // as RTP interarrival jitter
+
+// Ping awaiting echo.
+struct TelemetryPending {
+  int seq;                                // -1 if slot free
+  int64_t sent_us;                        // send time, in microseconds
+};
+
+// RTT stats for one connection.
+class ConnectionTelemetry {
+
+ private:
+  float m_rtt[TELEMETRY_WINDOW];          // ring of recent RTTs, in ms
+  bool m_lost[TELEMETRY_WINDOW];          // ring of recent outcomes
+  int m_rtt_count;                        // RTTs in window
+  int m_rtt_next;                         // next RTT slot
+  int m_outcome_count;                    // outcomes in window
+  int m_outcome_next;                     // next outcome slot
+  TelemetryPending m_pending[TELEMETRY_PENDING];
+  float m_ewma;                           // smoothed RTT, in ms
+  float m_jitter;                         // smoothed RTT change, in ms
+  float m_last;                           // last RTT, in ms
+
+  // Add outcome (lost or not) to window.
+  void addOutcome(bool lost);
+
+ public:
+
+  // Constructor.
+  ConnectionTelemetry();
+
+  // Note ping seq sent at time.
+  void sent(int seq, int64_t now_us);
+
+  // Note echo of ping seq (sent at sent_us) received at time.
+  // Return RTT in ms, or -1 if seq unknown (late, already lost).
+  float received(int seq, int64_t sent_us, int64_t now_us);
+
+  // Mark pings with no echo after timeout as lost.
+  void expire(int64_t now_us);
+
+  // Get number of RTT samples in window.
+  int getCount() const;
+
+  // Get last RTT (ms).
+  float getLast() const;
+
+  // Get min RTT in window (ms).
+  float getMin() const;
+
+  // Get smoothed RTT (ms).
+  float getEwma() const;
+
+  // Get RTT at percentile [0, 100] of window (ms).
+  float getPercentile(float percentile) const;
+
+  // Get jitter (ms).
+  float getJitter() const;
+
+  // Get fraction of pings in window lost [0, 1].
+  float getLoss() const;
+};
+
+// Two-letter acronym for easier access to telemetry.
+#define TM Telemetry::getInstance()
+
+class Telemetry {
+
+ private:
+  Telemetry();                            // Private since a singleton.
+  Telemetry(Telemetry const&);            // Don't allow copy.
+  void operator=(Telemetry const&);       // Don't allow assignment.
+
+  ConnectionTelemetry m_connection[TELEMETRY_CONNECTIONS];
+  FILE *m_p_file;                         // CSV time series, or NULL
+
+ public:
+
+  // Get the one and only instance of the Telemetry.
+  static Telemetry &getInstance();
+
+  // Destructor.
+  ~Telemetry();
+
+  // Get current time, in microseconds.
+  static int64_t now();
+
+  // Open CSV time series file (one row per RTT sample).
+  // Return 0 if ok, else -1.
+  int open(std::string filename);
+
+  // Note ping seq sent on connection.
+  void sent(int connection, int seq);
+
+  // Note echo of ping seq (sent at sent_us) received on connection.
+  // Return RTT in ms, or -1 if unknown (late, already lost).
+  float received(int connection, int seq, int64_t sent_us);
+
+  // Get stats for connection (NULL if out of range).
+  const ConnectionTelemetry *get(int connection) const;
+};
+
+#endif // TELEMETRY_H
@@ -18,6 +18,11 @@ Timer::Timer() {
   setColor(df::WHITE);
   registerInterest(df::STEP_EVENT); // Count ticks as seconds.
   setValue(50);
+  Registry<Timer>::insert(this, TIMER_TYPE);
+}
+
+Timer::~Timer() {
+  Registry<Timer>::remove(this);
 }
 
 // Handle event.
@@ -51,7 +56,7 @@ int Timer::step(const df::EventStep *p_e) {
   // Sound warning as time expires.
   if (getValue() < 13 && getValue() % 2 == 0 ||
       getValue() < 6 && getValue() > 0)
-    play_sound("beep");
+    play_sound(SOUND_BEEP);
 
   // Time running out - yellow.
   if (getValue() <= 20 && getValue() > 10)
@@ -9,9 +9,12 @@
 #include "Event.h"		
 #include "ViewObject.h"
 
+// Game includes.
+#include "Registry.h"
+
 #define TIMER_STRING "Timer"
 
-class Timer : public df::ViewObject {
+class Timer : public df::ViewObject, public Registered {
 
 private:
   // Handle step events.
@@ -22,6 +25,9 @@ public:
   // Constructor.
   Timer();
 
+  // Destructor.
+  ~Timer();
+
   // Handle events.
   int eventHandler(const df::Event *p_e) override;
 };
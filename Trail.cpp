@@ -0,0 +1,92 @@
+//
+// Trail.cpp
+//
+
+// Engine includes.
+#include "DisplayManager.h"
+#include "utility.h"
+
+// Game includes.
+#include "Trail.h"
+
+Trail::Trail() : m_vertices(sf::Quads) {
+  m_head = 0;
+  m_count = 0;
+  m_tick = 0;
+}
+
+// Add sample at (x,y) with color (r,g,b).
+// If full, oldest sample is overwritten.
+void Trail::add(float x, float y,
+		unsigned char r, unsigned char g, unsigned char b) {
+
+  // Full, so drop oldest.
+  if (m_count == TRAIL_MAX) {
+    m_head = (m_head + 1) % TRAIL_MAX;
+    m_count -= 1;
+  }
+
+  TrailSample &s = m_sample[(m_head + m_count) % TRAIL_MAX];
+  s.x = x;
+  s.y = y;
+  s.birth = m_tick;
+  s.r = r;
+  s.g = g;
+  s.b = b;
+  m_count += 1;
+}
+
+// Age trail one tick, dropping expired samples.
+void Trail::step() {
+
+  m_tick += 1;
+
+  // Samples are in age order, so expired ones are all at the head.
+  while (m_count > 0 && m_tick - m_sample[m_head].birth >= TRAIL_AGE) {
+    m_head = (m_head + 1) % TRAIL_MAX;
+    m_count -= 1;
+  }
+}
+
+// Draw all live samples in a single draw call.
+// Return 0 if ok, else -1.
+int Trail::draw() {
+
+  sf::RenderWindow *p_win = DM.getWindow();
+  if (!p_win)
+    return -1;
+
+  if (m_count == 0)
+    return 0;
+
+  // Samples are centered in their character cell.
+  float half_w = df::charWidth() / 2.0f;
+  float half_h = df::charHeight() / 2.0f;
+
+  m_vertices.resize(m_count * 4);
+  for (int i=0; i<m_count; i++) {
+    const TrailSample &s = m_sample[(m_head + i) % TRAIL_MAX];
+
+    // Fade out linearly over lifetime.
+    int left = TRAIL_AGE - (m_tick - s.birth);
+    sf::Color color(s.r, s.g, s.b, (sf::Uint8) (255 * left / TRAIL_AGE));
+
+    df::Vector p = df::spacesToPixels(df::worldToView(df::Vector(s.x, s.y)));
+    float x = p.getX() + half_w;
+    float y = p.getY() + half_h;
+
+    sf::Vertex *p_quad = &m_vertices[i * 4];
+    p_quad[0] = sf::Vertex(sf::Vector2f(x - TRAIL_SIZE, y - TRAIL_SIZE), color);
+    p_quad[1] = sf::Vertex(sf::Vector2f(x + TRAIL_SIZE, y - TRAIL_SIZE), color);
+    p_quad[2] = sf::Vertex(sf::Vector2f(x + TRAIL_SIZE, y + TRAIL_SIZE), color);
+    p_quad[3] = sf::Vertex(sf::Vector2f(x - TRAIL_SIZE, y + TRAIL_SIZE), color);
+  }
+  p_win -> draw(m_vertices);
+
+  return 0;
+}
+
+// Get number of live samples.
+int Trail::getCount() const {
+  return m_count;
+}
@@ -0,0 +1,56 @@
+//
+// Trail.h
+//
+// Sword trail kept as a fixed ring buffer of samples, aged and
+// drawn in one pass (instead of one Fader Object per sample).
+//
+
+#ifndef TRAIL_H
+#define TRAIL_H
+
+// System includes.
+#include <SFML/Graphics/VertexArray.hpp>
+
+// Trail settings.
+const int TRAIL_MAX = 4096;     // max samples per trail
+const int TRAIL_AGE = 20;       // in ticks
+const float TRAIL_SIZE = 2.0f;  // in pixels
+const int TRAIL_DENSITY = 10;   // samples per space
+
+// A single trail sample.
+struct TrailSample {
+  float x, y;                   // position, in spaces
+  int birth;                    // tick sample was added
+  unsigned char r, g, b;        // color
+};
+
+class Trail {
+
+ private:
+  TrailSample m_sample[TRAIL_MAX]; // ring buffer of samples
+  int m_head;                      // index of oldest sample
+  int m_count;                     // number of live samples
+  int m_tick;                      // ticks stepped so far
+  sf::VertexArray m_vertices;      // quads, refilled each draw
+
+ public:
+
+  // Constructor.
+  Trail();
+
+  // Add sample at (x,y) with color (r,g,b).
+  // If full, oldest sample is overwritten.
+  void add(float x, float y, unsigned char r, unsigned char g, unsigned char b);
+
+  // Age trail one tick, dropping expired samples.
+  void step();
+
+  // Draw all live samples in a single draw call.
+  // Return 0 if ok, else -1.
+  int draw();
+
+  // Get number of live samples.
+  int getCount() const;
+};
+
+#endif // TRAIL_H
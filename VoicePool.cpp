@@ -0,0 +1,110 @@
+//
+// VoicePool.cpp
+//
+
+// Game includes.
+#include "FrameBudget.h"
+#include "VoicePool.h"
+
+// Per category: priority (higher steals lower) and max voices.
+static const int PRIORITY[NUM_SOUND_CATEGORIES] = {3, 2, 1, 0};
+static const int CAP[NUM_SOUND_CATEGORIES] = {2, 1, 3, 2};
+
+VoicePool::VoicePool() {
+  for (int i=0; i<VOICE_MAX; i++) {
+    m_voice[i].category = -1;
+    m_voice[i].priority = -1;
+    m_voice[i].started = 0;
+  }
+  m_plays = 0;
+  m_dropped = 0;
+}
+
+// Get the one and only instance of the VoicePool.
+VoicePool &VoicePool::getInstance() {
+  static VoicePool voice_pool;
+  return voice_pool;
+}
+
+// Play buffer in category, stealing a voice if needed.
+// Return voice played on, or -1 if dropped.
+int VoicePool::play(const sf::SoundBuffer *p_buffer, SoundCategory category) {
+
+  if (!p_buffer || category < 0 || category >= NUM_SOUND_CATEGORIES)
+    return -1;
+  int priority = PRIORITY[category];
+
+  // Frame budget may allow fewer voices than pool has.
+  int voices = FB.getMaxVoices();
+  if (voices > VOICE_MAX)
+    voices = VOICE_MAX;
+
+  // One pass: count busy voices, and find free voice, oldest in same
+  // category and best voice to steal overall.
+  int busy = 0, in_category = 0;
+  int free_voice = -1, oldest_same = -1, steal = -1;
+  for (int i=0; i<VOICE_MAX; i++) {
+    Voice &v = m_voice[i];
+    if (v.category < 0 || v.sound.getStatus() != sf::Sound::Playing) {
+      if (free_voice < 0)
+	free_voice = i;
+      continue;
+    }
+    busy += 1;
+    if (v.category == category) {
+      in_category += 1;
+      if (oldest_same < 0 || v.started < m_voice[oldest_same].started)
+	oldest_same = i;
+    }
+    if (v.priority <= priority &&
+	(steal < 0 || v.priority < m_voice[steal].priority ||
+	 (v.priority == m_voice[steal].priority &&
+	  v.started < m_voice[steal].started)))
+      steal = i;
+  }
+
+  int use;
+  if (in_category >= CAP[category])
+    use = oldest_same;                   // replace own oldest
+  else if (busy < voices && free_voice >= 0)
+    use = free_voice;
+  else
+    use = steal;                         // -1 if all higher priority
+  if (use < 0) {
+    m_dropped += 1;
+    return -1;
+  }
+
+  Voice &v = m_voice[use];
+  v.sound.stop();
+  v.sound.setBuffer(*p_buffer);
+  v.category = category;
+  v.priority = priority;
+  v.started = ++m_plays;
+  v.sound.play();
+  return use;
+}
+
+// Stop all voices.
+void VoicePool::stopAll() {
+  for (int i=0; i<VOICE_MAX; i++) {
+    m_voice[i].sound.stop();
+    m_voice[i].sound.resetBuffer();
+    m_voice[i].category = -1;
+  }
+}
+
+// Get number of voices playing.
+int VoicePool::getPlaying() const {
+  int playing = 0;
+  for (int i=0; i<VOICE_MAX; i++)
+    if (m_voice[i].category >= 0 &&
+	m_voice[i].sound.getStatus() == sf::Sound::Playing)
+      playing += 1;
+  return playing;
+}
+
+// Get number of sounds dropped.
+int VoicePool::getDropped() const {
+  return m_dropped;
+}
@@ -0,0 +1,72 @@
+//
+// VoicePool.h
+//
+// Fixed pool of mixer voices (sf::Sound) for sound effects.  Each
+// play names a category; a category has a priority and a cap on how
+// many of its sounds play at once.  When a category is at its cap,
+// or all voices (as many as frame budget allows) are busy, the
+// oldest voice of lowest priority no higher than the new sound's is
+// stolen; if there is none, the new sound is dropped.  All costs are
+// a scan of the fixed pool.
+//
+
+#ifndef VOICE_POOL_H
+#define VOICE_POOL_H
+
+// SFML includes.
+#include <SFML/Audio.hpp>
+
+// VoicePool settings.
+const int VOICE_MAX = 8;             // voices in pool
+
+// Sound categories.
+enum SoundCategory {
+  VOICE_UI,                          // start, game over, timer beep
+  VOICE_KUDOS,
+  VOICE_SLICE,                       // splats
+  VOICE_SWIPE,
+  NUM_SOUND_CATEGORIES,
+};
+
+// One mixer voice.
+struct Voice {
+  sf::Sound sound;
+  int category;                      // -1 if never used
+  int priority;
+  long long started;                 // play count when started
+};
+
+// Two-letter acronym for easier access to voice pool.
+#define VP VoicePool::getInstance()
+
+class VoicePool {
+
+ private:
+  VoicePool();                       // Private since a singleton.
+  VoicePool(VoicePool const&);       // Don't allow copy.
+  void operator=(VoicePool const&);  // Don't allow assignment.
+
+  Voice m_voice[VOICE_MAX];
+  long long m_plays;                 // sounds started so far
+  int m_dropped;                     // sounds dropped, no voice
+
+ public:
+
+  // Get the one and only instance of the VoicePool.
+  static VoicePool &getInstance();
+
+  // Play buffer in category, stealing a voice if needed.
+  // Return voice played on, or -1 if dropped.
+  int play(const sf::SoundBuffer *p_buffer, SoundCategory category);
+
+  // Stop all voices.
+  void stopAll();
+
+  // Get number of voices playing.
+  int getPlaying() const;
+
+  // Get number of sounds dropped.
+  int getDropped() const;
+};
+
+#endif // VOICE_POOL_H
@@ -0,0 +1,411 @@
+//
+// fruit-bench - microbenchmarks for game hot kernels
+//
+// Runs headless, on synthetic data, with a fixed random seed.
+// Prints CSV to stdout, one row per benchmark and parameter:
+//   benchmark,param,iterations,median_ns,min_ns
+// where times are per operation, over BENCH_REPEATS repeats.
+// Also checks compositor batching; failures go to stderr and exit
+// status is 1.
+//
+
+// System includes.
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <math.h>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+// Engine includes.
+#include "DisplayManager.h"
+#include "EventNetworkCreate.h"
+#include "EventStep.h"
+#include "GameManager.h"
+#include "LogManager.h"
+#include "ResourceManager.h"
+#include "WorldManager.h"
+#include "utility.h"
+
+// Game includes.
+#include "BinLog.h"
+#include "Client.h"
+#include "Compositor.h"
+#include "Fruit.h"
+#include "Grocer.h"
+#include "Points.h"
+#include "Polyline.h"
+#include "Registry.h"
+#include "Server.h"
+#include "Sword.h"
+#include "Timer.h"
+#include "Trail.h"
+#include "util.h"
+
+const int BENCH_REPEATS = 7;        // median of these is reported
+const int BENCH_SEED = 1;           // fixed, for stable inputs
+const unsigned int ALL_ATTRIBUTES = (1u << df::ObjectAttributeMax) - 1;
+
+// Time fn (iterations calls per repeat) and print CSV row.
+// after, if given, runs untimed after each repeat (e.g. cleanup).
+static void bench(const char *name, int param, int iterations,
+		  std::function<void(int)> fn,
+		  std::function<void()> after = NULL) {
+
+  std::vector<double> ns_per_op;
+  for (int r=0; r<BENCH_REPEATS; r++) {
+    std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+    for (int i=0; i<iterations; i++)
+      fn(i);
+    std::chrono::steady_clock::time_point end =
+      std::chrono::steady_clock::now();
+    ns_per_op.push_back(std::chrono::duration<double, std::nano>
+			(end - start).count() / iterations);
+    if (after)
+      after();
+  }
+
+  std::sort(ns_per_op.begin(), ns_per_op.end());
+  printf("%s,%d,%d,%.1f,%.1f\n", name, param, iterations,
+	 ns_per_op[BENCH_REPEATS / 2], ns_per_op[0]);
+  fflush(stdout);
+}
+
+// Delete all Objects in list now.
+static void deleteAll(std::vector<df::Object *> &list) {
+  for (int i=0; i<(int) list.size(); i++)
+    WM.markForDelete(list[i]);
+  WM.update();
+  list.clear();
+}
+
+// Random position in world.
+static df::Vector randomPosition() {
+  return df::Vector((float) (rand() % (int) WM.getBoundary().getHorizontal()),
+		    (float) (rand() % (int) WM.getBoundary().getVertical()));
+}
+
+// Serialize all attributes of Object, then deserialize into copy.
+static void benchSerialize(const char *name, df::Object *p_o,
+			   df::Object *p_copy) {
+
+  std::stringstream ss;
+  std::string s = std::string(name) + "-serialize";
+  bench(s.c_str(), 0, 10000, [&](int) {
+    ss.str("");
+    ss.clear();
+    p_o -> serialize(&ss, ALL_ATTRIBUTES);
+  });
+
+  std::string bytes = ss.str();
+  s = std::string(name) + "-deserialize";
+  bench(s.c_str(), 0, 10000, [&](int) {
+    std::stringstream in(bytes);
+    p_copy -> deserialize(&in);
+  });
+}
+
+// Serialize and deserialize each synced game Object type.
+static void benchSerializeAll() {
+
+  Fruit *p_f = new Fruit(FRUIT[0]);
+  p_f -> start(WAVE_SPEED);
+  Fruit *p_f2 = new Fruit(FRUIT[0]);
+  benchSerialize("fruit", p_f, p_f2);
+
+  Sword *p_s = new Sword();
+  Sword *p_s2 = new Sword();
+  benchSerialize("sword", p_s, p_s2);
+
+  Grocer *p_g = new Grocer();
+  Grocer *p_g2 = new Grocer();
+  benchSerialize("grocer", p_g, p_g2);
+
+  std::vector<df::Object *> list = {p_f, p_f2, p_s, p_s2, p_g, p_g2};
+  deleteAll(list);
+}
+
+// Slice line, then sampled path, against every Fruit.
+static void benchSlice() {
+
+  int sizes[] = {10, 100, 1000};
+  for (int n : sizes) {
+
+    std::vector<df::Object *> list;
+    for (int i=0; i<n; i++) {
+      Fruit *p_f = new Fruit(FRUIT[i % NUM_FRUITS]);
+      p_f -> setPosition(randomPosition());
+      list.push_back(p_f);
+    }
+
+    std::vector<df::Line> lines;
+    for (int i=0; i<256; i++)
+      lines.push_back(df::Line(randomPosition(), randomPosition()));
+
+    int hits = 0;
+    bench("slice", n, 1000, [&](int i) {
+      df::Line line = lines[i % lines.size()];
+      for (int j=0; j<Registry<Fruit>::getCount(); j++)
+	if (df::lineIntersectsBox(line, df::getWorldBox(Registry<Fruit>::get(j))))
+	  hits += 1;
+    });
+
+    // One tick of 1 kHz mouse samples along an arc, as Sword::step
+    // slices on server (path built, then tested against every Fruit).
+    const int samples = 1000 / 30;
+    std::vector<std::vector<df::Vector>> arcs;
+    for (int i=0; i<256; i++) {
+      df::Vector center = randomPosition();
+      float radius = 5.0f + rand() % 20;
+      float from = (rand() % 360) * 3.14159f / 180;
+      std::vector<df::Vector> arc;
+      for (int k=0; k<=samples; k++) {
+	float a = from + k * 3.14159f / samples;
+	arc.push_back(center + df::Vector(radius * cosf(a), radius * sinf(a) / 2));
+      }
+      arcs.push_back(arc);
+    }
+    Polyline *p_path = new Polyline();
+    bench("slice-path", n, 1000, [&](int i) {
+      const std::vector<df::Vector> &arc = arcs[i % arcs.size()];
+      p_path -> start(arc[0]);
+      for (size_t k=1; k<arc.size(); k++)
+	p_path -> add(arc[k]);
+      for (int j=0; j<Registry<Fruit>::getCount(); j++)
+	if (p_path -> intersects(df::getWorldBox(Registry<Fruit>::get(j))))
+	  hits += 1;
+    });
+    delete p_path;
+
+    deleteAll(list);
+  }
+}
+
+// Add trail samples for swipes of different lengths (in spaces).
+static void benchTrail() {
+
+  int lengths[] = {1, 10, 50};
+  Trail *p_trail = new Trail();
+  df::Vector center(WM.getBoundary().getHorizontal() / 2,
+		    WM.getBoundary().getVertical() / 2);
+
+  for (int len : lengths) {
+    df::Vector p2 = center + df::Vector((float) len, 0.0f);
+    bench("trail", len, 10000, [&](int) {
+      create_trail(p_trail, center, p2, df::CYAN);
+      p_trail -> step();
+    });
+  }
+
+  delete p_trail;
+}
+
+// Compose frames of n still Fruit plus a moving sword, recorded in
+// memory (one batch per frame, only changed cells rebuilt).
+static void benchCompose() {
+
+  RecordingBackend recording;
+  CM.setBackend(&recording);
+  const BakedSprite *p_baked = bakeSprite(RM.getSprite(FRUIT[0]));
+
+  int sizes[] = {1, 10, 40};
+  for (int n : sizes) {
+    std::vector<df::Vector> where;
+    for (int i=0; i<n; i++)
+      where.push_back(randomPosition());
+    bench("compose", n, 1000, [&](int i) {
+      for (int j=0; j<n; j++)
+	CM.putFrame(p_baked, 0, where[j]);
+      CM.put(where[i % n], '+', df::WHITE);
+      CM.draw();
+    });
+  }
+
+  LM.writeLog("benchCompose(): %d batches, %lld vertices", recording.batches,
+	      recording.vertices);
+  CM.setBackend(NULL);
+}
+
+// Check compositor batching, recorded in memory: one batch per
+// frame, 4 vertices per cell plus 4 per free glyph, and only changed
+// cells rebuilt.  Return number of failed checks.
+static int checkCompose() {
+
+  int failed = 0;
+  RecordingBackend recording;
+  CM.setBackend(&recording);
+  int cells = DM.getHorizontal() * DM.getVertical();
+  df::Vector where = df::viewToWorld(df::Vector(10, 10));
+
+  // Frame 1: everything rebuilt (new backend), one free glyph.
+  CM.put(where, '+', df::WHITE);
+  CM.putFree(where, '*', df::RED, 45.0f);
+  CM.draw();
+  if (recording.batches != 1) {
+    fprintf(stderr, "checkCompose(): %d batches after 1 frame, want 1\n",
+	    recording.batches);
+    failed += 1;
+  }
+  if ((int) recording.last.getVertexCount() != (cells + 1) * 4) {
+    fprintf(stderr, "checkCompose(): %d vertices, want %d\n",
+	    (int) recording.last.getVertexCount(), (cells + 1) * 4);
+    failed += 1;
+  }
+
+  // Frame 2: same grid, so nothing rebuilt.
+  CM.put(where, '+', df::WHITE);
+  CM.draw();
+  if (CM.getChanged() != 0) {
+    fprintf(stderr, "checkCompose(): %d cells changed, want 0\n",
+	    CM.getChanged());
+    failed += 1;
+  }
+
+  // Frame 3: one cell changed.
+  CM.put(where, 'x', df::WHITE);
+  CM.draw();
+  if (CM.getChanged() != 1) {
+    fprintf(stderr, "checkCompose(): %d cells changed, want 1\n",
+	    CM.getChanged());
+    failed += 1;
+  }
+  if (recording.batches != 3 || (int) recording.last.getVertexCount() != cells * 4) {
+    fprintf(stderr, "checkCompose(): %d batches, %d vertices after 3 frames, want 3, %d\n",
+	    recording.batches, (int) recording.last.getVertexCount(), cells * 4);
+    failed += 1;
+  }
+
+  CM.setBackend(NULL);
+  return failed;
+}
+
+// Hot path log call (3 arguments, as Server::sync()), with binary
+// log on (param 1) and off (param 0).  Rings drained between repeats,
+// so no calls are dropped.
+static void benchBinLog() {
+
+  if (BL.startUp("bench.binlog") != 0)
+    return;
+  for (int enabled=1; enabled>=0; enabled--) {
+    BL.setEnabled(enabled == 1);
+    bench("binlog", enabled, 1000, [&](int i) {
+      BINLOG("benchBinLog(): SYNC type %d (id %d), sock_index %d",
+	     i % 5, i, -1);
+    }, [&]() {
+      while (BL.getPending() > 0)
+	std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+  }
+  BL.shutDown();
+}
+
+// Create each synced type, as Client does for each new Object.
+static void benchCreateObject(Client *p_client) {
+
+  std::vector<std::string> types;
+  for (int i=0; i<NUM_FRUITS; i++)
+    types.push_back(FRUIT[i]);
+  types.push_back(SWORD_STRING);
+  types.push_back(POINTS_STRING);
+  types.push_back(TIMER_STRING);
+
+  std::vector<df::Object *> list;
+  bench("create-object", (int) types.size(), 1000, [&](int i) {
+    list.push_back(p_client -> createObject(types[i % types.size()]));
+  }, [&]() { deleteAll(list); });
+}
+
+// Catch up new Fruit at different latencies (in ticks).
+static void benchCatchUp(Client *p_client) {
+
+  int latencies[] = {0, 3, 9, 30};
+  Fruit *p_f = new Fruit(FRUIT[0]);
+  df::EventNetworkCreate ev(df::NetworkEventLabel::DATA, p_f);
+
+  for (int latency : latencies) {
+    p_client -> setLatency(latency);
+    bench("catch-up", latency, 1000, [&](int) {
+      p_f -> start(WAVE_SPEED);
+      p_client -> eventNetworkCreate(&ev);
+    });
+  }
+
+  WM.markForDelete(p_f);
+  WM.update();
+}
+
+// Server sync step with n modified Objects (no clients connected, so
+// this is the registry walk and serialization, not the sends).
+static void benchServerStep() {
+
+  Server *p_server = new Server();
+  df::EventStep step;
+
+  int sizes[] = {10, 100, 1000};
+  for (int n : sizes) {
+
+    std::vector<df::Object *> list;
+    for (int i=0; i<n; i++)
+      list.push_back(new Points());
+
+    bench("server-step", n, 100, [&](int i) {
+      for (int j=0; j<(int) list.size(); j++)
+	((Points *) list[j]) -> setValue(i + j);
+      p_server -> handleStep(&step);
+    });
+
+    deleteAll(list);
+  }
+
+  WM.markForDelete(p_server);
+  WM.update();
+}
+
+///////////////////////////////////////////////
+int main() {
+
+  // Headless, same config as server.
+#if defined(_WIN32) || defined(_WIN64)
+  _putenv_s("DRAGONFLY_CONFIG", "df-config-server.txt");
+  _putenv_s("DRAGONFLY_LOG", "bench.log");
+#else
+  setenv("DRAGONFLY_CONFIG", "df-config-server.txt", 1);
+  setenv("DRAGONFLY_LOG", "bench.log", 1);
+#endif
+
+  // Start up game manager.
+  if (GM.startUp())  {
+    LM.writeLog("Error starting game manager!");
+    GM.shutDown();
+    return 1;
+  }
+  LM.setLogLevel(0);
+  loadResources();
+  srand(BENCH_SEED);
+
+  printf("benchmark,param,iterations,median_ns,min_ns\n");
+
+  benchSerializeAll();
+  benchSlice();
+  benchTrail();
+  benchCompose();
+  int failed = checkCompose();
+  benchBinLog();
+
+  // Client benchmarks first: Client and Server set network mode.
+  Client *p_client = new Client();
+  benchCreateObject(p_client);
+  benchCatchUp(p_client);
+  WM.markForDelete(WM.objectsOfType("ServerEntry"));
+  WM.markForDelete(p_client);
+  WM.update();
+
+  benchServerStep();
+
+  GM.shutDown();
+  return failed ? 1 : 0;
+}
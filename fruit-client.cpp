@@ -3,11 +3,15 @@
 // 
 
 // System includes.
+#include <chrono>
 #if !defined(_WIN32) && !defined(_WIN64)
 #include <unistd.h> // for getpid()
 #else
 #include <process.h>
 #endif
+#include <stdio.h>  // for fprintf()
+#include <stdlib.h> // for atoi()
+#include <string.h> // for strcmp()
 
 // Engine includes.
 #include "GameManager.h"
@@ -17,12 +21,41 @@
 #include "utility.h"
 
 // Game includes.
+#include "AssetPack.h"
+#include "BinLog.h"
 #include "Client.h"
+#include "InputSampler.h"
+#include "Telemetry.h"
+#include "VoicePool.h"
 #include "util.h"
 
+#if defined(__linux__)
+// From Xlib (header's macros clash with engine names).
+extern "C" int XInitThreads(void);
+#endif
+
 ///////////////////////////////////////////////
 int main(int argc, char *argv[]) {
 
+  // For time to interactive.
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  // Usage: client [-r mouse_rate_hz]
+  int input_rate_hz = INPUT_RATE_HZ;
+  for (int i=1; i<argc-1; i++)
+    if (strcmp(argv[i], "-r") == 0)
+      input_rate_hz = atoi(argv[++i]);
+  if (input_rate_hz <= 0) {
+    fprintf(stderr, "Usage: client [-r mouse_rate_hz]\n");
+    return 1;
+  }
+
+  // Mouse sampler thread shares SFML's X display, so Xlib must lock
+  // it (before any other Xlib call).
+#if defined(__linux__)
+  XInitThreads();
+#endif
+
   // Set environment for config file (server).
 #if defined(_WIN32) || defined(_WIN64)
   _putenv_s("DRAGONFLY_CONFIG", "df-config-client.txt");
@@ -56,6 +89,12 @@ int main(int argc, char *argv[]) {
   LM.setLogLevel(0);
   LM.setFlush(true);
   LM.writeLog("Fruit Ninjas (v%.1f)", VERSION);
+
+  // Hot path logging (client + pid), drained in background.
+  BL.startUp("log" + std::to_string(pid) + ".binlog");
+
+  // Round trip time series (client + pid).
+  TM.open("telemetry" + std::to_string(pid) + ".csv");
   
   // Load resources.
   loadResources();
@@ -66,12 +105,21 @@ int main(int argc, char *argv[]) {
   // Fruit Ninja splash screen.
   //splash();
 
-  new Client;
+  new Client(input_rate_hz);
+
+  // ServerEntry is up (sounds may still be decoding).
+  LM.writeLog("Time to interactive: %.1f ms",
+	      std::chrono::duration<float, std::milli>
+	      (std::chrono::steady_clock::now() - start).count());
 
   // Run game (this blocks until game loop is over).
   GM.run();
 
   // Shut everything down.
+  IS.shutDown();
+  VP.stopAll();
+  PACK.close();
+  BL.shutDown();
   GM.shutDown();
 
   // All is well.
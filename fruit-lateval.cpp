@@ -0,0 +1,146 @@
+//
+// fruit-lateval - evaluate latency estimators on recorded RTT traces
+//
+// Usage: fruit-lateval telemetry<pid>.csv ...
+// Replays each connection's ping round trips (the telemetry CSV the
+// client writes) through three estimators and scores how well each
+// predicts the next round trip:
+//   last   - last RTT, rounded to whole ticks (prediction before)
+//   ewma   - smoothed RTT, gain 1/8 (Telemetry)
+//   kalman - LatencyEstimator round trip (pings only; traces have no
+//            server times)
+// Prints CSV, one row per trace and estimator:
+//   trace,estimator,samples,mae_ms,rmse_ms,p95_ms,bias_ms,wobble_ms,sd_ms
+// where wobble is mean change between successive estimates and sd is
+// mean reported standard deviation (kalman only).
+//
+
+// System includes.
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+// Game includes.
+#include "LatencyEstimator.h"
+
+const float FRAME_MS = 33.0f;          // game tick, for step to time
+const float EWMA_GAIN = 0.125f;        // as TELEMETRY_EWMA_GAIN
+
+enum { EST_LAST, EST_EWMA, EST_KALMAN, NUM_ESTIMATORS };
+const char *ESTIMATOR_NAME[NUM_ESTIMATORS] = {"last", "ewma", "kalman"};
+
+// One ping echo from trace.
+struct TraceRow {
+  int step;
+  int connection;
+  float rtt_ms;
+};
+
+// Read telemetry CSV.  Return false if unable to open.
+static bool readTrace(const char *filename, std::vector<TraceRow> &rows) {
+  FILE *p_f = fopen(filename, "r");
+  if (!p_f)
+    return false;
+  char line[512];
+  while (fgets(line, sizeof(line), p_f)) {
+    TraceRow r;
+    int seq;
+    if (sscanf(line, "%d,%d,%d,%f", &r.step, &r.connection, &seq, &r.rtt_ms) == 4)
+      rows.push_back(r);
+  }
+  fclose(p_f);
+  return true;
+}
+
+// Score one connection's round trips and print a row per estimator.
+static void score(const char *trace, const std::vector<float> &rtt,
+		  const std::vector<int> &step) {
+
+  LatencyEstimator kalman;
+  float estimate[NUM_ESTIMATORS] = {0, 0, 0};
+  std::vector<float> error[NUM_ESTIMATORS];
+  double wobble[NUM_ESTIMATORS] = {0, 0, 0};
+  double sd_sum = 0;
+
+  for (size_t i=0; i<rtt.size(); i++) {
+
+    // Predict this sample from those before.
+    if (i > 0) {
+      for (int e=0; e<NUM_ESTIMATORS; e++)
+	error[e].push_back(estimate[e] - rtt[i]);
+      sd_sum += 2 * kalman.getStdDev();
+    }
+
+    // Then take it in.
+    float before[NUM_ESTIMATORS];
+    std::copy(estimate, estimate + NUM_ESTIMATORS, before);
+    estimate[EST_LAST] = floorf(rtt[i] / FRAME_MS + 0.5f) * FRAME_MS;
+    estimate[EST_EWMA] = i == 0 ? rtt[i] :
+      estimate[EST_EWMA] + EWMA_GAIN * (rtt[i] - estimate[EST_EWMA]);
+    int64_t received_us = (int64_t) (step[i] * FRAME_MS * 1000);
+    kalman.addPing(received_us - (int64_t) (rtt[i] * 1000), -1, received_us);
+    estimate[EST_KALMAN] = kalman.getRoundTrip();
+    if (i > 0)
+      for (int e=0; e<NUM_ESTIMATORS; e++)
+	wobble[e] += fabsf(estimate[e] - before[e]);
+  }
+
+  size_t n = rtt.size() > 1 ? rtt.size() - 1 : 0;
+  for (int e=0; e<NUM_ESTIMATORS; e++) {
+    if (n == 0)
+      break;
+    double abs_sum = 0, sq_sum = 0, sum = 0;
+    std::vector<float> abs_error;
+    for (float err : error[e]) {
+      abs_sum += fabsf(err);
+      sq_sum += err * err;
+      sum += err;
+      abs_error.push_back(fabsf(err));
+    }
+    std::sort(abs_error.begin(), abs_error.end());
+    printf("%s,%s,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n", trace, ESTIMATOR_NAME[e],
+	   (int) n, abs_sum / n, sqrt(sq_sum / n), abs_error[(size_t) (0.95 * (n - 1))],
+	   sum / n, wobble[e] / n, e == EST_KALMAN ? sd_sum / n : 0.0);
+  }
+}
+
+int main(int argc, char *argv[]) {
+
+  if (argc < 2) {
+    fprintf(stderr, "Usage: fruit-lateval telemetry.csv ...\n");
+    return 1;
+  }
+
+  printf("trace,estimator,samples,mae_ms,rmse_ms,p95_ms,bias_ms,wobble_ms,sd_ms\n");
+  for (int a=1; a<argc; a++) {
+    std::vector<TraceRow> rows;
+    if (!readTrace(argv[a], rows)) {
+      fprintf(stderr, "fruit-lateval: cannot read %s\n", argv[a]);
+      continue;
+    }
+
+    // Each connection is its own trace.
+    std::vector<int> connections;
+    for (const TraceRow &r : rows)
+      if (std::find(connections.begin(), connections.end(), r.connection) == connections.end())
+	connections.push_back(r.connection);
+    for (int c : connections) {
+      std::vector<float> rtt;
+      std::vector<int> step;
+      for (const TraceRow &r : rows)
+	if (r.connection == c) {
+	  rtt.push_back(r.rtt_ms);
+	  step.push_back(r.step);
+	}
+      std::string name = std::string(argv[a]);
+      if (connections.size() > 1)
+	name += ":" + std::to_string(c);
+      score(name.c_str(), rtt, step);
+    }
+  }
+
+  return 0;
+}
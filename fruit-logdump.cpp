@@ -0,0 +1,142 @@
+//
+// fruit-logdump - decode BinLog binary log to text
+//
+// Usage: fruit-logdump <file.binlog>
+// Prints one line per record: time (ms), thread, formatted message.
+//
+
+// System includes.
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Game includes.
+#include "BinLog.h"
+
+// Format record with printf-style format, one conversion per argument.
+static std::string format(const std::string &fmt, const BinRecord &r) {
+
+  std::string out;
+  int arg = 0;
+  size_t i = 0;
+  while (i < fmt.size()) {
+
+    if (fmt[i] != '%') {
+      out += fmt[i++];
+      continue;
+    }
+    if (i + 1 < fmt.size() && fmt[i+1] == '%') {
+      out += '%';
+      i += 2;
+      continue;
+    }
+
+    // Find end of conversion spec.
+    size_t j = i + 1;
+    while (j < fmt.size() && !strchr("diouxXcfFeEgGs", fmt[j]))
+      j++;
+    if (j == fmt.size()) {
+      out += fmt.substr(i);
+      break;
+    }
+    std::string spec = fmt.substr(i, j - i + 1);
+    char conv = fmt[j];
+    i = j + 1;
+
+    if (arg >= r.count) {
+      out += "<missing>";
+      continue;
+    }
+
+    // Strip length modifiers, then add own for 64-bit ints.
+    std::string flags;
+    for (size_t k=0; k<spec.size()-1; k++)
+      if (!strchr("hlLqjzt", spec[k]))
+	flags += spec[k];
+
+    char buff[128];
+    bool is_float = (strchr("fFeEgG", conv) != NULL);
+    if (is_float) {
+      double v = (r.type[arg] == BINLOG_DOUBLE) ?
+	r.arg[arg].f : (double) r.arg[arg].i;
+      snprintf(buff, sizeof(buff), (flags + conv).c_str(), v);
+    } else {
+      long long v = (r.type[arg] == BINLOG_INT) ?
+	(long long) r.arg[arg].i : (long long) r.arg[arg].f;
+      if (conv == 's')
+	conv = 'd';
+      snprintf(buff, sizeof(buff), (flags + "ll" + conv).c_str(), v);
+    }
+    out += buff;
+    arg += 1;
+  }
+
+  return out;
+}
+
+///////////////////////////////////////////////
+int main(int argc, char *argv[]) {
+
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s <file.binlog>\n", argv[0]);
+    return 1;
+  }
+
+  FILE *p_f = fopen(argv[1], "rb");
+  if (!p_f) {
+    fprintf(stderr, "Error! Unable to open '%s'.\n", argv[1]);
+    return 1;
+  }
+
+  char magic[4];
+  uint32_t version;
+  if (fread(magic, sizeof(magic), 1, p_f) != 1 ||
+      memcmp(magic, BINLOG_MAGIC, sizeof(magic)) != 0 ||
+      fread(&version, sizeof(version), 1, p_f) != 1 ||
+      version != BINLOG_VERSION) {
+    fprintf(stderr, "Error! '%s' is not a version %u binlog.\n",
+	    argv[1], BINLOG_VERSION);
+    fclose(p_f);
+    return 1;
+  }
+
+  std::vector<std::string> formats;
+  int kind;
+  while ((kind = fgetc(p_f)) != EOF) {
+
+    if (kind == BINLOG_FORMAT) {
+      uint16_t id, len;
+      if (fread(&id, sizeof(id), 1, p_f) != 1 ||
+	  fread(&len, sizeof(len), 1, p_f) != 1)
+	break;
+      std::string fmt(len, ' ');
+      if (len > 0 && fread(&fmt[0], len, 1, p_f) != 1)
+	break;
+      if (id >= formats.size())
+	formats.resize(id + 1);
+      formats[id] = fmt;
+
+    } else if (kind == BINLOG_RECORD) {
+      uint8_t thread;
+      BinRecord r;
+      if (fread(&thread, sizeof(thread), 1, p_f) != 1 ||
+	  fread(&r, sizeof(r), 1, p_f) != 1)
+	break;
+      if (r.count > BINLOG_MAX_ARGS)
+	r.count = BINLOG_MAX_ARGS;
+      std::string msg = (r.fmt < formats.size()) ?
+	format(formats[r.fmt], r) : "<unknown format " + std::to_string(r.fmt) + ">";
+      printf("%12.3f %2u %s\n", r.time / 1.0e6, thread, msg.c_str());
+
+    } else {
+      fprintf(stderr, "Error! Bad entry '%c' at offset %ld.\n",
+	      kind, ftell(p_f) - 1);
+      fclose(p_f);
+      return 1;
+    }
+  }
+
+  fclose(p_f);
+  return 0;
+}
@@ -0,0 +1,101 @@
+//
+// fruit-pack - pre-decode sound effects into one pack file
+//
+// Usage: fruit-pack [sounds-dir] [output]
+// Defaults are "sounds" and "fruit.pack".  Every .wav in directory is
+// decoded to 16-bit PCM and stored under its name without extension,
+// the label loadResources() looks up.  See AssetPack.h for file layout.
+//
+
+// System includes.
+#include <algorithm>
+#include <filesystem>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Game includes.
+#include "AssetPack.h"
+
+// Round up to multiple of 8.
+static uint64_t align8(uint64_t n) {
+  return (n + 7) & ~(uint64_t) 7;
+}
+
+int main(int argc, char *argv[]) {
+
+  std::string dir = argc > 1 ? argv[1] : "sounds";
+  std::string out = argc > 2 ? argv[2] : PACK_FILE;
+
+  // Find sound files, sorted so pack is the same each run.
+  std::vector<std::filesystem::path> files;
+  std::error_code ec;
+  for (const auto &entry : std::filesystem::directory_iterator(dir, ec))
+    if (entry.path().extension() == ".wav")
+      files.push_back(entry.path());
+  if (ec) {
+    fprintf(stderr, "fruit-pack: cannot read %s\n", dir.c_str());
+    return 1;
+  }
+  std::sort(files.begin(), files.end());
+
+  // Decode each.
+  std::vector<sf::SoundBuffer> buffers(files.size());
+  std::vector<PackEntry> entries(files.size());
+  uint64_t offset = align8(sizeof(PackHeader) + files.size() * sizeof(PackEntry));
+  for (size_t i=0; i<files.size(); i++) {
+    std::string label = files[i].stem().string();
+    if (label.size() >= (size_t) PACK_LABEL_LEN) {
+      fprintf(stderr, "fruit-pack: name too long: %s\n", label.c_str());
+      return 1;
+    }
+    if (!buffers[i].loadFromFile(files[i].string())) {
+      fprintf(stderr, "fruit-pack: cannot decode %s\n", files[i].string().c_str());
+      return 1;
+    }
+    PackEntry &e = entries[i];
+    memset(&e, 0, sizeof(e));
+    strcpy(e.label, label.c_str());
+    e.channels = buffers[i].getChannelCount();
+    e.sample_rate = buffers[i].getSampleRate();
+    e.sample_count = buffers[i].getSampleCount();
+    e.offset = offset;
+    offset = align8(offset + e.sample_count * sizeof(int16_t));
+  }
+
+  // Write header, entries, then samples.
+  FILE *p_f = fopen(out.c_str(), "wb");
+  if (!p_f) {
+    fprintf(stderr, "fruit-pack: cannot write %s\n", out.c_str());
+    return 1;
+  }
+  PackHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+  h.version = PACK_VERSION;
+  h.count = (uint32_t) entries.size();
+  fwrite(&h, sizeof(h), 1, p_f);
+  if (!entries.empty())
+    fwrite(entries.data(), sizeof(PackEntry), entries.size(), p_f);
+
+  static const char zero[8] = {0};
+  uint64_t at = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+  for (size_t i=0; i<entries.size(); i++) {
+    fwrite(zero, 1, (size_t) (entries[i].offset - at), p_f);
+    fwrite(buffers[i].getSamples(), sizeof(int16_t),
+	   (size_t) entries[i].sample_count, p_f);
+    at = entries[i].offset + entries[i].sample_count * sizeof(int16_t);
+    printf("%-16s %u ch %6u Hz %8llu samples\n", entries[i].label,
+	   entries[i].channels, entries[i].sample_rate,
+	   (unsigned long long) entries[i].sample_count);
+  }
+
+  if (fclose(p_f) != 0) {
+    fprintf(stderr, "fruit-pack: error writing %s\n", out.c_str());
+    return 1;
+  }
+  printf("%s: %d sounds, %llu bytes\n", out.c_str(), (int) entries.size(),
+	 (unsigned long long) at);
+  return 0;
+}
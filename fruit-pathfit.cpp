@@ -0,0 +1,150 @@
+//
+// fruit-pathfit - error/bandwidth trade-off of spline Sword relay
+//
+// Usage: fruit-pathfit [seconds]
+// Runs synthetic swipes (240 Hz mouse samples, fixed random seed)
+// through SplineFitter for a range of error thresholds and hold
+// times, rebuilds the curve as the other client would, and prints
+// CSV, one row per setting:
+//   error,hold,messages_per_s,bytes_per_s,max_error,mean_error,mean_lag_ms
+// The first row (error -1) is relaying latest position every tick
+// the Sword moved, as before splines, in the same message format.
+//
+
+// System includes.
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// Game includes.
+#include "Spline.h"
+
+const int SAMPLE_HZ = 240;             // mouse samples per second
+const int TICK_HZ = 30;                // game ticks per second
+const int SEED = 1;                    // fixed, for stable inputs
+const float PI = 3.14159265f;
+
+// Synthetic mouse samples: curved swipes with pauses between.
+// Sample i is at tick i * TICK_HZ / SAMPLE_HZ.
+static std::vector<df::Vector> makeSwipes(int seconds) {
+  srand(SEED);
+  std::vector<df::Vector> samples;
+  float x = 60, y = 20;
+  while ((int) samples.size() < seconds * SAMPLE_HZ) {
+
+    // Swipe: arc at speed 20-80 spaces per second, 0.2-0.6 seconds.
+    float speed = 20.0f + rand() % 60;
+    float heading = (rand() % 360) * PI / 180;
+    float turn = ((rand() % 200) - 100) / 100.0f * PI;  // radians, whole swipe
+    int n = SAMPLE_HZ * (20 + rand() % 40) / 100;
+    for (int i=0; i<n; i++) {
+      heading += turn / n;
+      x += cosf(heading) * speed / SAMPLE_HZ;
+      y += sinf(heading) * speed / SAMPLE_HZ / 2;  // spaces are taller
+      if (x < 0 || x > 120) heading = PI - heading;
+      if (y < 0 || y > 40) heading = -heading;
+      samples.push_back(df::Vector(x, y));
+    }
+
+    // Pause: mouse still, 0.1-0.5 seconds.
+    n = SAMPLE_HZ * (10 + rand() % 40) / 100;
+    for (int i=0; i<n; i++)
+      samples.push_back(df::Vector(x, y));
+  }
+  return samples;
+}
+
+// Run samples through fitter (error < 0: every tick) and print row.
+static void run(const std::vector<df::Vector> &samples, float error,
+		int hold, int seconds) {
+
+  SplineFitter fitter(error < 0 ? 0 : error, hold);
+  fitter.reset(samples[0]);
+  SplinePath client;
+  client.reset(samples[0]);
+  df::Vector start = samples[0];                  // of segment, at client
+  std::vector<char> buffer;
+  long long messages = 0, bytes = 0;
+  double lag_ticks = 0;
+  float max_error = 0;
+  double sum_error = 0;
+  size_t covered = 0;                             // samples sent so far
+
+  int per_tick = SAMPLE_HZ / TICK_HZ;
+  int ticks = (int) samples.size() / per_tick;
+  for (int t=0; t<ticks; t++) {
+
+    std::vector<df::Vector> points;
+    if (error < 0) {
+      // Before splines: latest position, if moved.
+      df::Vector last = samples[(t + 1) * per_tick - 1];
+      if (!(last == start))
+	points.push_back(last);
+    } else {
+      for (int i=t*per_tick; i<(t+1)*per_tick; i++)
+	if (i == 0 || !(samples[i] == samples[i - 1]))
+	  fitter.add(samples[i]);
+      fitter.step(points);
+    }
+    if (points.empty())
+      continue;
+
+    messages += 1;
+    bytes += encodeSpline(0, 0, points.data(), (int) points.size(), buffer);
+    for (size_t p=0; p<points.size(); p++) {
+      df::Vector segment[SPLINE_STEPS];
+      if (error < 0) {
+	for (int k=1; k<=SPLINE_STEPS; k++)  // straight, as trail was
+	  segment[k - 1] = start + df::Vector(
+	    (points[p].getX() - start.getX()) * k / SPLINE_STEPS,
+	    (points[p].getY() - start.getY()) * k / SPLINE_STEPS);
+      } else
+	client.append(points[p], segment);
+
+      // Samples up to this control point are now at client: lag,
+      // and distance to segment drawn for them.
+      size_t end = covered;
+      while (end < samples.size() && !(samples[end] == points[p]))
+	end += 1;
+      for (size_t i=covered; i<=end && i<samples.size(); i++) {
+	lag_ticks += t - (double) i / per_tick;
+	float best = distanceToSegment(samples[i], start, segment[0]);
+	for (int k=0; k+1<SPLINE_STEPS; k++) {
+	  float d = distanceToSegment(samples[i], segment[k], segment[k + 1]);
+	  if (d < best)
+	    best = d;
+	}
+	if (best > max_error)
+	  max_error = best;
+	sum_error += best;
+      }
+      covered = end + 1;
+      start = segment[SPLINE_STEPS - 1];
+    }
+  }
+  size_t n = covered < samples.size() ? covered : samples.size();
+
+  printf("%.2f,%d,%.1f,%.1f,%.3f,%.3f,%.1f\n", error, hold,
+	 (double) messages / seconds, (double) bytes / seconds,
+	 max_error, n ? sum_error / n : 0.0,
+	 n ? lag_ticks / n * 1000 / TICK_HZ : 0.0);
+}
+
+int main(int argc, char *argv[]) {
+
+  int seconds = argc > 1 ? atoi(argv[1]) : 60;
+  if (seconds < 1)
+    seconds = 1;
+  std::vector<df::Vector> samples = makeSwipes(seconds);
+
+  printf("error,hold,messages_per_s,bytes_per_s,max_error,mean_error,mean_lag_ms\n");
+  run(samples, -1, 0, seconds);
+  float errors[] = {0.1f, 0.25f, 0.5f, 1.0f, 2.0f};
+  int holds[] = {1, 2, 4};
+  for (float error : errors)
+    for (int hold : holds)
+      run(samples, error, hold, seconds);
+
+  return 0;
+}
@@ -3,6 +3,7 @@
 //
 
 // System includes.
+#include <stdio.h>  // for fprintf()
 
 // Engine includes.
 #include "GameManager.h"
@@ -12,7 +13,11 @@
 #include "utility.h"
 
 // Game includes.
+#include "BinLog.h"
+#include "NetTrace.h"
 #include "Server.h"
+#include "StatsServer.h"
+#include "Telemetry.h"
 #include "util.h"
 
 ///////////////////////////////////////////////
@@ -36,9 +41,27 @@ int main(int argc, char *argv[]) {
   LM.setFlush(true);
   LM.setLogLevel(0);
   LM.writeLog("Fruit Ninjas (v%.1f)", VERSION);
+
+  // Hot path logging, drained in background.
+  BL.startUp("server.binlog");
+
+  // Live counters for operators (see fruit-stats).
+  STATS.startUp();
+  TM.open("telemetry-server.csv");
+
+  // Network traces to replay, one per socket (see NetTrace.h).
+  // Any missing would shift the rest, so run would not compare.
+  for (int i=1; i<argc; i++)
+    if (NT.load(argv[i]) != 0) {
+      fprintf(stderr, "server: unable to load trace %s (see server.log)\n", argv[i]);
+      STATS.shutDown();
+      BL.shutDown();
+      GM.shutDown();
+      return 1;
+    }
   
-  // Load resources.
-  loadResources();
+  // Load resources (server profile: no splash sprites, no sounds).
+  loadResources(RESOURCES_SERVER);
 
   // Start server game object.
   new Server();
@@ -47,6 +70,8 @@ int main(int argc, char *argv[]) {
   GM.run();
 
   // Shut everything down.
+  STATS.shutDown();
+  BL.shutDown();
   GM.shutDown();
 
   // All is well.
@@ -0,0 +1,95 @@
+//
+// fruit-stats - poll live counters from a running server
+//
+// Usage: fruit-stats [interval_s] [port]
+// Prints server stats snapshot (JSON) once, or every interval_s
+// seconds until interrupted.  Server must be on this host.
+//
+
+// System includes.
+#if defined(_WIN32) || defined(_WIN64)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+typedef SOCKET socket_t;
+#define close_socket closesocket
+#define sleep_seconds(s) Sleep((s) * 1000)
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int socket_t;
+#define INVALID_SOCKET (-1)
+#define close_socket close
+#define sleep_seconds(s) sleep(s)
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// Game includes.
+#include "StatsServer.h"
+
+// Fetch snapshot from server.
+// Return 0 if ok, else -1.
+static int fetch(int port, std::string &body) {
+
+  socket_t s = socket(AF_INET, SOCK_STREAM, 0);
+  if (s == INVALID_SOCKET)
+    return -1;
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons((unsigned short) port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(s, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+    close_socket(s);
+    return -1;
+  }
+
+  const char *request = "GET / HTTP/1.0\r\n\r\n";
+  send(s, request, (int) strlen(request), 0);
+
+  std::string response;
+  char buff[4096];
+  int n;
+  while ((n = (int) recv(s, buff, sizeof(buff), 0)) > 0)
+    response.append(buff, n);
+  close_socket(s);
+
+  // Body follows blank line after headers.
+  size_t start = response.find("\r\n\r\n");
+  if (start == std::string::npos)
+    return -1;
+  body = response.substr(start + 4);
+  return 0;
+}
+
+///////////////////////////////////////////////
+int main(int argc, char *argv[]) {
+
+  int interval = argc > 1 ? atoi(argv[1]) : 0;
+  int port = argc > 2 ? atoi(argv[2]) : STATS_PORT;
+
+#if defined(_WIN32) || defined(_WIN64)
+  WSADATA wsa;
+  WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+
+  do {
+    std::string body;
+    if (fetch(port, body) != 0) {
+      fprintf(stderr, "Error! No server stats at 127.0.0.1:%d.\n", port);
+      return 1;
+    }
+    fputs(body.c_str(), stdout);
+    fflush(stdout);
+    if (interval > 0)
+      sleep_seconds(interval);
+  } while (interval > 0);
+
+  return 0;
+}
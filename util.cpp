@@ -3,10 +3,18 @@
 //
 
 // System includes.
+#if defined(_WIN32) || defined(_WIN64)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+#include <chrono>
 #include <string.h>
+#include <vector>
 
 // Engine includes.
-#include "Fader.h"
 #include "GameManager.h"
 #include "LogManager.h"
 #include "NetworkManager.h"
@@ -14,54 +22,107 @@
 #include "utility.h"
 
 // Game includes.
+#include "AssetPack.h"
+#include "FrameBudget.h"
 #include "Grocer.h"
 #include "Points.h"
+#include "Profiler.h"
 #include "Splash.h"
+#include "SpriteBake.h"
 #include "Sword.h"
 #include "Timer.h"
+#include "Trail.h"
+#include "VoicePool.h"
 #include "util.h"
 
 ///////////////////////////////////////////////
-// Load resources (sprites, sound effects, music).
-void loadResources(void) {
+// Load resources (sprites, sound effects, music) for profile.
+// Logs load time and peak resident memory, to compare profiles.
+void loadResources(ResourceProfile profile) {
 
-  // Splash sprites.
-  RM.loadSprite("sprites/fruit-splash.txt", "fruit-splash");
-  RM.loadSprite("sprites/ninja-splash.txt", "ninja-splash");
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  int sprites = 0, sounds = 0;
+
+  // Splash sprites (client splash screen only).
+  if (profile == RESOURCES_CLIENT) {
+    sprites += RM.loadSprite("sprites/fruit-splash.txt", "fruit-splash") == 0;
+    sprites += RM.loadSprite("sprites/ninja-splash.txt", "ninja-splash") == 0;
+  }
 
   // Fruit sprites.
   for (int i=0; i<NUM_FRUITS; i++) {
     std::string name = "sprites/" + FRUIT[i] + ".txt";
-    RM.loadSprite(name, FRUIT[i]);
+    sprites += RM.loadSprite(name, FRUIT[i]) == 0;
   }
 
   // Other sprites.
-  RM.loadSprite("sprites/kudos.txt", "kudos");
-  RM.loadSprite("sprites/gameover.txt", "gameover");
-
-  // Sounds.
-  RM.loadSound("sounds/game-start.wav", "game-start");
-  RM.loadSound("sounds/game-over.wav", "game-over");
-  RM.loadSound("sounds/impact.wav", "impact");
-  RM.loadSound("sounds/beep.wav", "beep");
-  
-  for (int i=1; i<=NUM_SPLATS; i++) {
-    std::string sound = "splat-" + std::to_string(i);
-    std::string file = "sounds/" + sound + ".wav";
-    RM.loadSound(file, sound);
-  }
+  sprites += RM.loadSprite("sprites/kudos.txt", "kudos") == 0;
+  sprites += RM.loadSprite("sprites/gameover.txt", "gameover") == 0;
 
-  for (int i=1; i<=NUM_SWIPES; i++) {
-    std::string sound = "swipe-" + std::to_string(i);
-    std::string file = "sounds/" + sound + ".wav";
-    RM.loadSound(file, sound);
+  // Bake sprites client draws or explodes into glyph runs.
+  if (profile == RESOURCES_CLIENT) {
+    for (int i=0; i<NUM_FRUITS; i++)
+      bakeSprite(RM.getSprite(FRUIT[i]));
+    bakeSprite(RM.getSprite("kudos"));
   }
 
-  for (int i=1; i<=NUM_KUDOS; i++) {
-    std::string sound = "kudos-" + std::to_string(i);
-    std::string file = "sounds/" + sound + ".wav";
-    RM.loadSound(file, sound);
+  // Sounds (play_sound() does nothing on server), in SoundId order.
+  // Pre-decoded pack if there is one (see fruit-pack), else decode
+  // each WAV file in background.  Client waits for them before first
+  // sync.
+  if (profile == RESOURCES_CLIENT) {
+    std::vector<std::pair<std::string, std::string>> files;
+    files.push_back({"game-start", "sounds/game-start.wav"});
+    files.push_back({"game-over", "sounds/game-over.wav"});
+    files.push_back({"impact", "sounds/impact.wav"});
+    files.push_back({"beep", "sounds/beep.wav"});
+
+    for (int i=1; i<=NUM_SPLATS; i++) {
+      std::string sound = "splat-" + std::to_string(i);
+      files.push_back({sound, "sounds/" + sound + ".wav"});
+    }
+
+    for (int i=1; i<=NUM_SWIPES; i++) {
+      std::string sound = "swipe-" + std::to_string(i);
+      files.push_back({sound, "sounds/" + sound + ".wav"});
+    }
+
+    for (int i=1; i<=NUM_KUDOS; i++) {
+      std::string sound = "kudos-" + std::to_string(i);
+      files.push_back({sound, "sounds/" + sound + ".wav"});
+    }
+
+    PACK.open();
+    PACK.load(files);
+    sounds = (int) files.size();
   }
+
+  float ms = std::chrono::duration<float, std::milli>
+    (std::chrono::steady_clock::now() - start).count();
+  LM.writeLog("loadResources(): %s profile%s: %d sprites, %d sounds in %.1f ms, peak resident %ld KB",
+	      profile == RESOURCES_SERVER ? "server" : "client",
+	      PACK.isOpen() ? " (pack)" : sounds ? " (sounds in background)" : "",
+	      sprites, sounds, ms, residentKB());
+}
+
+///////////////////////////////////////////////
+// Return peak resident memory of process (KB), or -1 if unknown.
+long residentKB(void) {
+#if defined(_WIN32) || defined(_WIN64)
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+    return -1;
+  return (long) (pmc.PeakWorkingSetSize / 1024);
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return -1;
+#if defined(__APPLE__)
+  return (long) (usage.ru_maxrss / 1024);  // bytes on Mac
+#else
+  return (long) usage.ru_maxrss;           // KB on Linux
+#endif
+#endif
 }
 
 ///////////////////////////////////////////////
@@ -72,36 +133,42 @@ void splash(void) {
 }
 
 ///////////////////////////////////////////////
-// Create trail from p1 to p2.
-void create_trail(df::Vector p1, df::Vector p2, df::Color color) {
-  
-  static float size = 2;
-  static int age = 20;
-  static int opacity = 255;
-  static unsigned char r, g, b;
+// Create trail from p1 to p2, added to sword trail.
+void create_trail(Trail *p_trail, df::Vector p1, df::Vector p2, df::Color color) {
+
+  PROFILE_SCOPE(PROFILE_TRAIL);
+
+  if (!p_trail)
+    return;
+
+  unsigned char r, g, b;
   df::colorToRGB(color, r, g, b);
   
   // Calculate step size for interpolation.
-  float dist = df::distance(p1, p2) * 10;
+  float dist = df::distance(p1, p2) * FB.getTrailDensity();
   float dX = (p1.getX() - p2.getX()) / (dist + 1.0f);
   float dY = (p1.getY() - p2.getY()) / (dist + 1.0f);
   
-  // Create Fader particles on line from p1 to p2.
+  // Add trail samples on line from p1 to p2.
   for (int i=0; i<dist; i++) {
     float x = p2.getX() + dX*i;
     float y = p2.getY() + dY*i;
-    df::Fader *p_f = new df::Fader(size, age, opacity, r, g, b);
-    p_f -> setPosition(df::Vector(x,y));
+    p_trail -> add(x, y, r, g, b);
   }
 }
 
 ///////////////////////////////////////////////
-// Play indicated sound.
-void play_sound(std::string sound) {
+// Play indicated sound (SoundId) on voice pool.
+void play_sound(int sound) {
   if (NM.isServer() == false) {
-    df::Sound *p_sound = RM.getSound(sound);
-    if (p_sound)
-      p_sound->play();
+    SoundCategory category = VOICE_UI;
+    if (sound >= SOUND_KUDOS)
+      category = VOICE_KUDOS;
+    else if (sound >= SOUND_SWIPE)
+      category = VOICE_SWIPE;
+    else if (sound >= SOUND_SPLAT)
+      category = VOICE_SLICE;
+    VP.play(PACK.getBuffer(sound), category);
   }
 }
 
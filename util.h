@@ -8,6 +8,8 @@
 // Engine includes.
 #include "Color.h"
 
+class Trail;  // Forward reference.
+
 const int DELAY = 9;//1 ticks = 33ms; 9 ticks = 297ms
 
 const float VERSION = 1.0;
@@ -32,11 +34,27 @@ const float EXPLOSION_ROTATE = 1.0f; // in degrees
 
 const int SWORD_ID = 100; // base sword id for sync
 
+// Points settings.
+const int SLICE_POINTS = 10;  // per Fruit sliced
+const int MISS_POINTS = -25;  // per Fruit missed, to every player
+
 // Sound settings.
 const int NUM_SPLATS = 6;
 const int NUM_SWIPES = 7;
 const int NUM_KUDOS = 10;
 
+// Sound handles, in load order.
+enum SoundId {
+  SOUND_GAME_START,
+  SOUND_GAME_OVER,
+  SOUND_IMPACT,
+  SOUND_BEEP,
+  SOUND_SPLAT,                                // NUM_SPLATS of these
+  SOUND_SWIPE = SOUND_SPLAT + NUM_SPLATS,     // NUM_SWIPES of these
+  SOUND_KUDOS = SOUND_SWIPE + NUM_SWIPES,     // NUM_KUDOS of these
+  NUM_SOUNDS = SOUND_KUDOS + NUM_KUDOS,
+};
+
 // Wave settings.
 const int NUM_WAVES = NUM_FRUITS;
 const int WAVE_LEN = 300;      // in ticks
@@ -45,6 +63,13 @@ const float WAVE_SPEED = 0.5f; // in ticks
 const float SPEED_INC = 0.1f;  // in spaces/tick
 const int SPAWN_INC = -5 ;     // in ticks
 
+// Resource profiles.  Server only needs what simulation uses: sprite
+// frames for Fruit boxes and for objects it creates and syncs.
+enum ResourceProfile {
+  RESOURCES_CLIENT,   // all sprites and sounds
+  RESOURCES_SERVER,   // game sprites only, no splash, no sounds
+};
+
 // Map socket index to location.
 df::ViewObjectLocation sockToLocation(int sock_index);
 
@@ -54,9 +79,10 @@ df::Color sockToColor(int sock_index);
 ////////////////////////////////////////////////////
 // Fruit Ninja game functions.
 
-void loadResources(void);
+void loadResources(ResourceProfile profile = RESOURCES_CLIENT);
+long residentKB(void);
 void splash(void);
-void create_trail(df::Vector p1, df::Vector p2, df::Color color);
-void play_sound(std::string sound);
+void create_trail(Trail *p_trail, df::Vector p1, df::Vector p2, df::Color color);
+void play_sound(int sound);
 
 #endif // UTIL_H